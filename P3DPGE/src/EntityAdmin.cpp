@@ -77,6 +77,9 @@ TODO(p,delle) add physics based collision resolution for all entities
 
 //system includes
 #include "systems/System.h"						//EntityAdmin.h
+
+//the headless build only has the systems the benchmarks add themselves, so it never creates or updates a full admin
+#ifndef P3DPGE_HEADLESS
 #include "systems/TimeSystem.h"					//System.h |cpp->| Time.h, Command.h
 #include "systems/ScreenSystem.h"				//System.h |cpp->| Screen.h
 #include "systems/CommandSystem.h"				//System.h |cpp->| Command.h, Input.h, Canvas.h
@@ -95,9 +98,11 @@ TODO(p,delle) add physics based collision resolution for all entities
 #ifdef DEBUG_P3DPGE
 #include "systems/DebugSystem.h"
 #endif
+#endif //P3DPGE_HEADLESS
 
 //// EntityAdmin ////
 
+#ifndef P3DPGE_HEADLESS
 void EntityAdmin::Create(olc::PixelGameEngine* p) {
 	g_cBuffer.allocate_space(100);
 
@@ -148,6 +153,7 @@ void EntityAdmin::Create(olc::PixelGameEngine* p) {
 	AddSystem(new DebugSystem());
 #endif	
 }
+#endif //P3DPGE_HEADLESS
 
 void EntityAdmin::Cleanup() {
 	//cleanup collections
@@ -169,7 +175,10 @@ void EntityAdmin::Cleanup() {
 	delete tempCanvas;
 }
 
+#ifndef P3DPGE_HEADLESS
 void EntityAdmin::Update() {
+	physicsWorld->paused = paused || time->paused;
+
 	if (!paused) {
 		for (System* s : systems) {
 			steady_clock::time_point startTime = steady_clock::now(); //TODO(,delle) test that system durations work
@@ -189,6 +198,7 @@ void EntityAdmin::Update() {
 		}
 	}
 }
+#endif //P3DPGE_HEADLESS
 
 void EntityAdmin::AddSystem(System* system) {
 	systems.push_back(system);
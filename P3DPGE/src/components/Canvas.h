@@ -10,6 +10,7 @@ struct Canvas : public Component {
 	bool hideAll;
 
 	bool SHOW_FPS_GRAPH = false;
+	bool SHOW_RENDER_STATS = false;
 
 	Canvas() {
 		containers = std::vector<UIContainer*>();
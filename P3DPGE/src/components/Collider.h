@@ -3,16 +3,32 @@
 #include "../math/Matrix3.h"
 #include "../math/Vector3.h"
 #include "../math/InertiaTensors.h"
+#include "../geometry/Triangle.h"
+#include "../geometry/BVH.h"
+#include "../geometry/ConvexHull.h"
 #include "Physics.h"
 
+#include <future>
+
 struct Command;
 
 struct Collider : public Component {
 	Matrix3 inertiaTensor;
+	Matrix3 inverseInertiaTensor;		//local space, computed once when the tensor is set
+	Matrix3 worldInverseInertiaTensor;	//world space, refreshed by PhysicsSystem when the rotation changes
+	Vector3 inertiaRotation;			//the rotation worldInverseInertiaTensor was last computed with
 	int8 collisionLayer = 0;
 
 	bool isTrigger = false;
 	Command* command = nullptr; //TODO(p,delle) implement trigger colliders
+
+	//sets the local inertia tensor and caches its inverse, the world inverse starts out unrotated
+	void SetInertiaTensor(const Matrix3& tensor) {
+		inertiaTensor = tensor;
+		inverseInertiaTensor = tensor.Inverse();
+		worldInverseInertiaTensor = inverseInertiaTensor;
+		inertiaRotation = Vector3::ZERO;
+	}
 };
 
 //rotatable box
@@ -24,7 +40,7 @@ struct BoxCollider : public Collider {
 		this->halfDims = halfDimensions;
 		this->collisionLayer = collisionLayer;
 		this->isTrigger = false;
-		this->inertiaTensor = InertiaTensors::SolidCuboid(2*abs(halfDims.x), 2*abs(halfDims.x), 2*abs(halfDims.x), mass);
+		SetInertiaTensor(InertiaTensors::SolidCuboid(2*abs(halfDims.x), 2*abs(halfDims.x), 2*abs(halfDims.x), mass));
 	}
 
 	BoxCollider(Entity* e, Vector3 halfDimensions, float mass, bool isTrigger, Command* command, int8 collisionLayer = 0) {
@@ -34,7 +50,7 @@ struct BoxCollider : public Collider {
 		this->isTrigger = isTrigger;
 		this->command = command;
 		if(!isTrigger) {
-			this->inertiaTensor = InertiaTensors::SolidCuboid(2*abs(halfDims.x), 2*abs(halfDims.x), 2*abs(halfDims.x), mass);
+			SetInertiaTensor(InertiaTensors::SolidCuboid(2*abs(halfDims.x), 2*abs(halfDims.x), 2*abs(halfDims.x), mass));
 		}
 	}
 };
@@ -48,7 +64,7 @@ struct AABBCollider : public Collider {
 		this->halfDims = halfDimensions;
 		this->collisionLayer = collisionLayer;
 		this->isTrigger = false;
-		this->inertiaTensor = InertiaTensors::SolidCuboid(2*abs(halfDims.x), 2*abs(halfDims.x), 2*abs(halfDims.x), mass);
+		SetInertiaTensor(InertiaTensors::SolidCuboid(2*abs(halfDims.x), 2*abs(halfDims.x), 2*abs(halfDims.x), mass));
 	}
 
 	AABBCollider(Entity* e, Vector3 halfDimensions, float mass, bool isTrigger, Command* command, int8 collisionLayer = 0) {
@@ -58,7 +74,7 @@ struct AABBCollider : public Collider {
 		this->isTrigger = isTrigger;
 		this->command = command;
 		if(!isTrigger) {
-			this->inertiaTensor = InertiaTensors::SolidCuboid(2*abs(halfDims.x), 2*abs(halfDims.x), 2*abs(halfDims.x), mass);
+			SetInertiaTensor(InertiaTensors::SolidCuboid(2*abs(halfDims.x), 2*abs(halfDims.x), 2*abs(halfDims.x), mass));
 		}
 	}
 };
@@ -71,7 +87,7 @@ struct SphereCollider : public Collider {
 		this->radius= radius;
 		this->collisionLayer = collisionLayer;
 		this->isTrigger = false;
-		this->inertiaTensor = InertiaTensors::SolidSphere(radius, mass);
+		SetInertiaTensor(InertiaTensors::SolidSphere(radius, mass));
 	}
 
 	SphereCollider(Entity* e, float radius, float mass, bool isTrigger, Command* command, int8 collisionLayer = 0) {
@@ -81,12 +97,98 @@ struct SphereCollider : public Collider {
 		this->isTrigger = isTrigger;
 		this->command = command;
 		if(!isTrigger) {
-			this->inertiaTensor = InertiaTensors::SolidSphere(radius, mass);
+			SetInertiaTensor(InertiaTensors::SolidSphere(radius, mass));
+		}
+	}
+};
+
+//static triangle mesh, collisions against it are resolved per triangle found through its BVH
+//the mesh is treated as immovable, so it should be on a static Physics
+struct MeshCollider : public Collider {
+	std::vector<Vector3> vertices; //local space, 3 per triangle
+	BVH bvh;
+	std::future<void> buildTask;
+
+	//copies the triangles' local points and builds the BVH on a worker thread
+	MeshCollider(Entity* e, const std::vector<Triangle>& triangles, int8 collisionLayer = 0) {
+		this->entity = e;
+		this->collisionLayer = collisionLayer;
+		this->isTrigger = false;
+		vertices.reserve(triangles.size() * 3);
+		for(const Triangle& t : triangles) {
+			vertices.push_back(t.poffsets[0]);
+			vertices.push_back(t.poffsets[1]);
+			vertices.push_back(t.poffsets[2]);
+		}
+		buildTask = std::async(std::launch::async, [this]() { bvh.Build(vertices); });
+	}
+
+	//collisions are skipped until the BVH finishes building
+	bool Ready() {
+		return buildTask.valid() && buildTask.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+};
+
+//a list of child colliders offset from the entity, resolved as if each child was its own body
+struct CompoundCollider : public Collider {
+	std::vector<Collider*> children;
+	std::vector<Vector3> offsets; //local space offsets of each child from the entity's position
+
+	CompoundCollider(Entity* e, int8 collisionLayer = 0) {
+		this->entity = e;
+		this->collisionLayer = collisionLayer;
+		this->isTrigger = false;
+	}
+
+	~CompoundCollider() {
+		for(Collider* c : children) { delete c; }
+	}
+
+	void AddChild(Collider* child, Vector3 offset) {
+		child->entity = entity;
+		children.push_back(child);
+		offsets.push_back(offset);
+	}
+};
+
+//convex hull around a point cloud, collided through GJK so unlike MeshCollider it can be on a moving body
+struct ConvexPolyCollider : public Collider {
+	std::vector<Vector3> vertices; //local space hull vertices
+	std::vector<uint32> indices;	//3 per outward facing hull triangle
+	Vector3 halfDims;				//local space bounds, the inertia tensor is approximated as this box
+
+	ConvexPolyCollider(Entity* e, const std::vector<Vector3>& vertices, const std::vector<uint32>& indices, float mass, int8 collisionLayer = 0) {
+		this->entity = e;
+		this->vertices = vertices;
+		this->indices = indices;
+		this->collisionLayer = collisionLayer;
+		this->isTrigger = false;
+		halfDims = Vector3::ZERO;
+		for(const Vector3& v : vertices) {
+			halfDims = Vector3(fmaxf(halfDims.x, fabs(v.x)), fmaxf(halfDims.y, fabs(v.y)), fmaxf(halfDims.z, fabs(v.z)));
 		}
+		SetInertiaTensor(InertiaTensors::SolidCuboid(2*halfDims.x, 2*halfDims.y, 2*halfDims.z, mass));
+	}
+
+	//builds the hull of a mesh's triangles, or loads it from the .hull cache next to sourcePath if that is up to date
+	//maxVertices of 0 keeps the full hull, otherwise the hull is simplified down to that many vertices
+	//returns nullptr if the mesh is flat or has too few points to make a hull
+	static ConvexPolyCollider* FromMesh(Entity* e, const std::vector<Triangle>& triangles, const std::string& sourcePath,
+										float mass, uint32 maxVertices = 0, int8 collisionLayer = 0) {
+		std::vector<Vector3> points;
+		points.reserve(triangles.size() * 3);
+		for(const Triangle& t : triangles) {
+			points.push_back(t.poffsets[0]);
+			points.push_back(t.poffsets[1]);
+			points.push_back(t.poffsets[2]);
+		}
+
+		std::vector<Vector3> vertices;
+		std::vector<uint32> indices;
+		if(!ConvexHull::FromCachedSource(sourcePath, points, maxVertices, vertices, indices)) { return nullptr; }
+		return new ConvexPolyCollider(e, vertices, indices, mass, collisionLayer);
 	}
 };
 
-//TODO(p,delle) implement convexPolyCollider
 //TODO(p,delle) implement capsuleCollider
-//TODO(p,delle) implement cylinder collider
-//TODO(p,delle) implement complex collider (collider list)
\ No newline at end of file
+//TODO(p,delle) implement cylinder collider
\ No newline at end of file
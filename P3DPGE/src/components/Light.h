@@ -1,6 +1,7 @@
 #pragma once
 #include "Component.h"
 #include "../math/Vector3.h"
+#include "../render/ShadowMap.h"
 
 struct Light : public Component {
 	Vector3 position;
@@ -8,13 +9,20 @@ struct Light : public Component {
 	float strength;
 	//Geometry* shape;
 
-	//OpenGL's tutorial used int but we may want to experiment
-	//with using float later on 
-	std::vector<int> depthTexture;
+	//when the shadow map is rendered again
+	enum ShadowUpdate : uint8 {
+		SHADOW_UPDATE_NONE,			//no shadows from this light
+		SHADOW_UPDATE_ONCE,			//rendered once and kept, for lights over scenes that never move
+		SHADOW_UPDATE_ON_CHANGE,	//when the light or a shadow casting mesh has moved
+		SHADOW_UPDATE_EVERY_FRAME
+	};
+	ShadowUpdate shadowUpdate = SHADOW_UPDATE_ON_CHANGE;
+	int32 shadowResolution = 1024; //texels along each side of the shadow map
+	ShadowMap shadowMap;
 
 	Light(const Vector3& position, const Vector3& direction, float strength = 1.f) {
 		this->position = position;
 		this->direction = direction;
 		this->strength = strength;
 	}
-};
\ No newline at end of file
+};
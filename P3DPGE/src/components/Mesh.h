@@ -4,33 +4,207 @@
 
 #include "../math/Vector3.h"
 #include "../geometry/Triangle.h"
+#include "../geometry/MeshSimplifier.h"
 #include "../animation/Armature.h"
+#include "../render/Texture.h"
+
+#include <atomic>
+#include <map>
+#include <tuple>
+
+//a triangle of a mesh's vertex buffers as a plane in local space, normal.dot(point) == offset on it
+//the camera is moved into local space once per mesh, so back-face culling is a dot product per triangle
+struct FacePlane {
+	Vector3 normal;
+	float offset;
+};
 
 struct Mesh : public Component {
 	Armature* armature = nullptr;
 	std::vector<Triangle> triangles;
 
+	//the triangles' local points with shared corners merged, so the renderer transforms each one once per frame
+	//indices holds 3 per triangle in the same order as triangles
+	std::vector<Vector3> vertices;
+	std::vector<uint32> indices;
+
+	//local space bounds of vertices, rebuilt with them so the renderer can cull the whole mesh before touching its triangles
+	Vector3 boundsMin;
+	Vector3 boundsMax;
+	Vector3 sphereCenter;
+	float sphereRadius = 0;
+
+	//one per triangle of indices, and of each level's indices
+	std::vector<FacePlane> facePlanes;
+	std::vector<std::vector<FacePlane>> lodFacePlanes;
+
+	//the transform MeshSystem last moved the triangles' points and normals to
+	bool transformApplied = false;
+	Vector3 appliedPosition;
+	Vector3 appliedRotation;
+
 	bool has_texture = false;
-	olc::Sprite* texture = nullptr;
+	Texture* texture = nullptr;
+
+	//drawn into the occlusion buffer so meshes behind it can be skipped, meant for large solid meshes like walls and terrain
+	bool occluder = false;
+
+	//drawn into lights' shadow maps
+	bool castsShadows = true;
+
+	//changes whenever the buffers or levels are rebuilt, unique across meshes so a new mesh at a deleted one's address
+	//doesnt look like it, lets the renderer tell when a frame it drew from this mesh is out of date
+	uint32 version = 0;
+
+	//simplified copies from GenerateLODs, lods[0] is level 1 and level 0 is the mesh itself
+	//lodLevel is the level the renderer drew last, kept between frames so switching can lag behind for hysteresis
+	static const uint32 MAX_LODS = 4;
+	std::vector<MeshSimplifier::Level> lods;
+	uint32 lodLevel = 0;
 
 	//single triangle mesh for testing
 	Mesh(Triangle t) {
 		triangles.push_back(t);
+		BuildVertexBuffers();
 	}
 
 	Mesh(std::vector<Triangle> triangles, Armature* armature = 0) {
 		this->armature = armature;
 		this->triangles = triangles;
+		BuildVertexBuffers();
+	}
+
+	//a new version for every rebuild of any mesh
+	static uint32 NextVersion() {
+		static std::atomic<uint32> next(0);
+		return ++next;
+	}
+
+	//a plane through each triangle of the buffers, degenerate triangles get a zero normal which no camera is in front of
+	static void BuildFacePlanes(const std::vector<Vector3>& vertices, const std::vector<uint32>& indices, std::vector<FacePlane>& planes) {
+		planes.resize(indices.size() / 3);
+		for(size_t i = 0; i < planes.size(); ++i) {
+			const Vector3& a = vertices[indices[3 * i]];
+			Vector3 normal = (vertices[indices[3 * i + 1]] - a).trueCross(vertices[indices[3 * i + 2]] - a).normalized();
+			planes[i].normal = normal;
+			planes[i].offset = normal.dot(a);
+		}
+	}
+
+	//rebuilds vertices and indices from the triangles' poffsets, corners at exactly the same point become one vertex
+	//and caches each triangle's local normal and area
+	void BuildVertexBuffers() {
+		auto less = [](const Vector3& a, const Vector3& b) {
+			if(a.x != b.x) return a.x < b.x;
+			if(a.y != b.y) return a.y < b.y;
+			return a.z < b.z;
+		};
+		std::map<Vector3, uint32, decltype(less)> lookup(less);
+
+		vertices.clear();
+		indices.clear();
+		indices.reserve(triangles.size() * 3);
+		for(Triangle& t : triangles) {
+			t.cache_normal_and_area();
+			for(int i = 0; i < 3; ++i) {
+				auto it = lookup.find(t.poffsets[i]);
+				if(it == lookup.end()) {
+					it = lookup.insert(std::make_pair(t.poffsets[i], (uint32)vertices.size())).first;
+					vertices.push_back(t.poffsets[i]);
+				}
+				indices.push_back(it->second);
+			}
+		}
+
+		//the sphere is centered on the box rather than fit exactly, its only a quick first test before the box
+		boundsMin = Vector3( INFINITY,  INFINITY,  INFINITY);
+		boundsMax = Vector3(-INFINITY, -INFINITY, -INFINITY);
+		for(const Vector3& v : vertices) {
+			boundsMin = Vector3(std::min(boundsMin.x, v.x), std::min(boundsMin.y, v.y), std::min(boundsMin.z, v.z));
+			boundsMax = Vector3(std::max(boundsMax.x, v.x), std::max(boundsMax.y, v.y), std::max(boundsMax.z, v.z));
+		}
+		if(vertices.empty()) { boundsMin = Vector3::ZERO; boundsMax = Vector3::ZERO; }
+		sphereCenter = (boundsMin + boundsMax) / 2.f;
+		float radiusSq = 0;
+		for(const Vector3& v : vertices) {
+			Vector3 d = v - sphereCenter;
+			radiusSq = std::max(radiusSq, d.dot(d));
+		}
+		sphereRadius = sqrtf(radiusSq);
+		BuildFacePlanes(vertices, indices, facePlanes);
+
+		//the old levels were made from the old vertices
+		lods.clear();
+		lodFacePlanes.clear();
+		lodLevel = 0;
+		transformApplied = false;
+		version = NextVersion();
 	}
 
+	//builds the simplified levels, each about half the triangles of the last, meshes under twice minTriangles get none
+	void GenerateLODs(uint32 maxLevels = MAX_LODS, uint32 minTriangles = 64) {
+		//the levels carry texture coordinates and colors per vertex, so corners are only merged when those match too
+		//and the seams where they dont stay put
+		std::map<std::tuple<float, float, float, float, float, float, uint32>, uint32> lookup;
+		std::vector<Vector3> splitVertices;
+		std::vector<Vector3> splitUVs;
+		std::vector<uint32> splitColors;
+		std::vector<uint32> splitIndices;
+		splitIndices.reserve(triangles.size() * 3);
+		for(const Triangle& t : triangles) {
+			for(int i = 0; i < 3; ++i) {
+				const Vector3& p = t.poffsets[i];
+				const Vector3& uv = t.tex_points[i];
+				auto key = std::make_tuple(p.x, p.y, p.z, uv.x, uv.y, uv.z, t.color.n);
+				auto it = lookup.find(key);
+				if(it == lookup.end()) {
+					it = lookup.insert(std::make_pair(key, (uint32)splitVertices.size())).first;
+					splitVertices.push_back(p);
+					splitUVs.push_back(uv);
+					splitColors.push_back(t.color.n);
+				}
+				splitIndices.push_back(it->second);
+			}
+		}
+
+		MeshSimplifier::Simplify(splitVertices, splitUVs, splitColors, splitIndices, lods, maxLevels, minTriangles);
+		lodFacePlanes.resize(lods.size());
+		for(size_t i = 0; i < lods.size(); ++i) {
+			BuildFacePlanes(lods[i].vertices, lods[i].indices, lodFacePlanes[i]);
+		}
+		lodLevel = 0;
+		version = NextVersion();
+	}
+
+	//the buffers of a level
+	const std::vector<Vector3>& LODVertices(uint32 level) const { return level ? lods[level - 1].vertices : vertices; }
+	const std::vector<uint32>& LODIndices(uint32 level) const { return level ? lods[level - 1].indices : indices; }
+	const std::vector<FacePlane>& LODFacePlanes(uint32 level) const { return level ? lodFacePlanes[level - 1] : facePlanes; }
+
+	//the texture coordinates and color of a level's triangle, level 0 takes them from triangles and the rest from their own vertices
+	void LODAttributes(uint32 level, uint32 triangle, Vector3 uvs[3], olc::Pixel& color) const {
+		if(!level) {
+			const Triangle& t = triangles[triangle];
+			for(int i = 0; i < 3; ++i) { uvs[i] = t.tex_points[i]; }
+			color = t.color;
+			return;
+		}
+		const MeshSimplifier::Level& lod = lods[level - 1];
+		for(int i = 0; i < 3; ++i) { uvs[i] = lod.uvs[lod.indices[3 * triangle + i]]; }
+		color = olc::Pixel(lod.colors[lod.indices[3 * triangle]]);
+	}
+
+	//how far level's surface may be from the full mesh's, in local units
+	float LODError(uint32 level) const { return level ? lods[level - 1].error : 0; }
+
 	~Mesh() {
 		if(armature) {
 			delete armature;
 		}
 	}
 
-	//TODO(r, sushi) make it so you can do this with a custom texture
-	static Mesh* CreateBox(Entity* e, Vector3 halfDims, Vector3 position) {
+	//uses the uv grid sprite when no texture is given
+	static Mesh* CreateBox(Entity* e, Vector3 halfDims, Vector3 position, Texture* texture = nullptr) {
 		std::vector<Triangle> triangles;
 
 		Vector3 p1 = halfDims.xInvert().yInvert().zInvert();
@@ -64,7 +238,13 @@ struct Mesh : public Component {
 		Mesh* m = new Mesh(triangles);
 		m->entity = e;
 		//m->entity->GetComponent<Transform>()->lookDir = Vector3::ZERO;
-		m->texture = new olc::Sprite("sprites/UV_Grid_Sm.jpg");
+		if(texture) {
+			m->texture = texture;
+		} else {
+			//the grid is only for seeing how uvs land, so it doesnt need 32 bit color
+			olc::Sprite sprite("sprites/UV_Grid_Sm.jpg");
+			m->texture = new Texture(&sprite, Texture::FILTER_BILINEAR, Texture::FORMAT_RGB565);
+		}
 		return m;
 	}
 
@@ -127,6 +307,7 @@ struct Mesh : public Component {
 
 		Mesh* m = new Mesh(triangles);
 		m->entity = e;
+		m->GenerateLODs();
 
 		return m;
 	}
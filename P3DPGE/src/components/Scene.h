@@ -1,16 +1,17 @@
 #pragma once
 #include "Component.h"
 #include "Mesh.h"
+#include "../render/Framebuffer.h"
+#include "../render/DebugDraw.h"
 
 struct Light;
-struct Edge3D;
 //struct Mesh;
 
 struct Scene : public Component {
 	std::vector<Mesh*> meshes;
-	std::vector<Edge3D*> lines;
+	DebugDraw debug; //lines drawn over the scene for one frame
 	std::vector<Light*> lights;
-	std::vector<float> pixelDepthBuffer;
+	Framebuffer framebuffer;
 
 	bool RENDER_WIREFRAME				= true;
 	bool RENDER_EDGE_NUMBERS			= false;
@@ -24,13 +25,24 @@ struct Scene : public Component {
 	bool RENDER_GRID					= false; //TODO(r,delle) upgrade grid to follow camera in smart way
 	bool RENDER_LIGHT_RAYS				= false;
 	bool RENDER_MESH_NORMALS			= false;
+	bool RENDER_MESH_BOUNDS				= false; //the culling box and sphere of meshes in view
+	bool OCCLUSION_CULLING				= true; //skip meshes hidden behind meshes marked as occluders
+	bool LEVEL_OF_DETAIL				= true; //draw simplified meshes when they're small on screen
+	bool RENDER_SHADOWS					= false; //darken pixels in the shadow of the first light that has a shadow map
+	bool VISIBILITY_BUFFER				= false; //shade each visible pixel once after rasterizing instead of every time its drawn over
+	bool RENDER_THREADED				= false; //render each frame on its own thread while the next one is simulated
+	bool DYNAMIC_RESOLUTION				= false; //rasterize below the screen's resolution when the raster stage is over its time budget
+	bool REUSE_FRAMES					= true; //show the last framebuffer again when nothing it was drawn from has changed
+	bool IDLE_THROTTLE					= true; //slow the main loop down while frames are being reused
 
 
-	Scene(olc::PixelGameEngine* p) {
+	Scene(olc::PixelGameEngine* p) : Scene(p->ScreenWidth(), p->ScreenHeight()) {}
+
+	//for headless admins that render without a window
+	Scene(int32 width, int32 height) {
 		meshes = std::vector<Mesh*>();
 		lights = std::vector<Light*>();
-		lights = std::vector<Light*>();
-		pixelDepthBuffer = std::vector<float>((size_t)p->ScreenWidth() * (size_t)p->ScreenHeight());
+		framebuffer.Resize(width, height);
 	}
 
 	//returns a bounding box of the entire scene two Vector3's, the first being the upper corner of the box
@@ -12,6 +12,16 @@ struct Screen : public Component {
 	Vector3 mousePosV3;
 	bool changedResolution;
 
+	//for headless admins that render without a window
+	Screen(float width, float height) {
+		this->width = width;
+		this->height = height;
+		resolution = width * height;
+		dimensions = Vector2(width, height);
+		dimensionsV3 = Vector3(width, height);
+		changedResolution = true;
+	}
+
 	Screen(olc::PixelGameEngine* p) {
 		width = p->ScreenWidth();
 		height = p->ScreenHeight();
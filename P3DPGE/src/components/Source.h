@@ -4,8 +4,14 @@
 #include "Transform.h"
 #include "../math/Vector3.h"
 
+//the headless build has no OpenAL, its sources are only ever flagged to play
+#ifndef P3DPGE_HEADLESS
 #include "al.h"
 #include "alc.h"
+#else
+typedef unsigned int ALuint;
+typedef int ALint;
+#endif
 
 //this is what OpenAL sees as the source of sound in 3D space
 struct Source : public Component {
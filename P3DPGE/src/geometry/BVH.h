@@ -0,0 +1,112 @@
+#pragma once
+#include "../math/Vector3.h"
+
+#include <vector>
+#include <algorithm>
+
+//a node is a leaf if count > 0, then it references count triangles starting at indices[first]
+//otherwise its children are nodes[first] and nodes[first + 1]
+struct BVHNode {
+	Vector3 min;
+	Vector3 max;
+	uint32 first = 0;
+	uint32 count = 0;
+};
+
+//bounding volume hierarchy over a triangle list (3 vertices per triangle) built by splitting
+//the triangle centroids at the median of the longest axis
+struct BVH {
+	std::vector<BVHNode> nodes;
+	std::vector<uint32> indices;	//triangle indices, reordered so each leaf is a contiguous range
+	std::vector<Vector3> centroids;	//only used while building
+
+	void Build(const std::vector<Vector3>& vertices, uint32 maxLeafSize = 4) {
+		uint32 triCount = vertices.size() / 3;
+		nodes.clear();
+		indices.resize(triCount);
+		centroids.resize(triCount);
+		if(triCount == 0) { return; }
+
+		for(uint32 i = 0; i < triCount; ++i) {
+			indices[i] = i;
+			centroids[i] = (vertices[i*3] + vertices[i*3+1] + vertices[i*3+2]) / 3.f;
+		}
+
+		nodes.reserve(2 * triCount / maxLeafSize + 1);
+		nodes.push_back(BVHNode());
+		nodes[0].first = 0;
+		nodes[0].count = triCount;
+
+		//iterative build so deep trees dont blow the worker's stack
+		std::vector<uint32> stack;
+		stack.push_back(0);
+		while(!stack.empty()) {
+			uint32 n = stack.back(); stack.pop_back();
+			uint32 first = nodes[n].first;
+			uint32 count = nodes[n].count;
+
+			Vector3 min( INFINITY,  INFINITY,  INFINITY);
+			Vector3 max(-INFINITY, -INFINITY, -INFINITY);
+			Vector3 cmin = min, cmax = max;
+			for(uint32 i = first; i < first + count; ++i) {
+				for(int v = 0; v < 3; ++v) {
+					const Vector3& p = vertices[indices[i]*3 + v];
+					min = Vector3(fminf(min.x, p.x), fminf(min.y, p.y), fminf(min.z, p.z));
+					max = Vector3(fmaxf(max.x, p.x), fmaxf(max.y, p.y), fmaxf(max.z, p.z));
+				}
+				const Vector3& c = centroids[indices[i]];
+				cmin = Vector3(fminf(cmin.x, c.x), fminf(cmin.y, c.y), fminf(cmin.z, c.z));
+				cmax = Vector3(fmaxf(cmax.x, c.x), fmaxf(cmax.y, c.y), fmaxf(cmax.z, c.z));
+			}
+			nodes[n].min = min;
+			nodes[n].max = max;
+			if(count <= maxLeafSize) { continue; }
+
+			//split on the longest axis of the centroid bounds
+			Vector3 extent = cmax - cmin;
+			int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+			uint32 mid = first + count / 2;
+			std::nth_element(indices.begin() + first, indices.begin() + mid, indices.begin() + first + count,
+				[&](uint32 a, uint32 b) {
+					return axis == 0 ? centroids[a].x < centroids[b].x : (axis == 1 ? centroids[a].y < centroids[b].y : centroids[a].z < centroids[b].z);
+				});
+
+			uint32 left = nodes.size();
+			nodes.push_back(BVHNode());
+			nodes.push_back(BVHNode());
+			nodes[left].first = first;
+			nodes[left].count = mid - first;
+			nodes[left + 1].first = mid;
+			nodes[left + 1].count = first + count - mid;
+			nodes[n].first = left;
+			nodes[n].count = 0;
+			stack.push_back(left);
+			stack.push_back(left + 1);
+		}
+		centroids.clear();
+		centroids.shrink_to_fit();
+	}
+
+	//calls callback(triangleIndex) for every triangle whose leaf bounds overlap the box
+	template<class F>
+	void Query(const Vector3& min, const Vector3& max, F callback) const {
+		if(nodes.empty()) { return; }
+		uint32 stack[64];
+		int top = 0;
+		stack[top++] = 0;
+		while(top > 0) {
+			const BVHNode& node = nodes[stack[--top]];
+			if(node.min.x > max.x || node.max.x < min.x ||
+			   node.min.y > max.y || node.max.y < min.y ||
+			   node.min.z > max.z || node.max.z < min.z) {
+				continue;
+			}
+			if(node.count > 0) {
+				for(uint32 i = node.first; i < node.first + node.count; ++i) { callback(indices[i]); }
+			} else if(top < 63) {
+				stack[top++] = node.first;
+				stack[top++] = node.first + 1;
+			}
+		}
+	}
+};
@@ -0,0 +1,329 @@
+#pragma once
+#include "../math/Vector3.h"
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+//quickhull over a point cloud, producing hull vertices and outward facing triangles
+//hulls can be simplified by stopping once maxVertices have been added; since quickhull always
+//adds the point farthest out first, the early hull is the best coarse fit of the points
+namespace ConvexHull {
+
+	struct HullFace {
+		uint32 v[3];
+		Vector3 normal;
+		float offset;
+		std::vector<uint32> outside; //points above this face
+		uint32 farthest = 0; //the outside point highest above the face
+		float farthestDist = 0;
+		bool alive = true;
+	};
+
+	//directed edges are keyed as from << 32 | to, the neighbour across an edge owns the reversed key
+	inline unsigned long long EdgeKey(uint32 from, uint32 to) {
+		return ((unsigned long long)from << 32) | to;
+	}
+
+	//NOTE Vector3::normalized() leaves vectors within .001 of zero alone, which small faces easily are
+	inline Vector3 PlaneNormal(const Vector3& a, const Vector3& b, const Vector3& c) {
+		Vector3 n = (b - a).trueCross(c - a);
+		float length = n.mag();
+		return (length > 0) ? n / length : n;
+	}
+
+	inline void SetFacePlane(HullFace& f, const std::vector<Vector3>& points) {
+		f.normal = PlaneNormal(points[f.v[0]], points[f.v[1]], points[f.v[2]]);
+		f.offset = f.normal.dot(points[f.v[0]]);
+	}
+
+	//assigns each point to the first face its above, points inside every face are dropped
+	inline void AssignOutside(std::vector<HullFace>& faces, const std::vector<uint32>& newFaces, const std::vector<uint32>& candidates,
+							  const std::vector<Vector3>& points, float epsilon) {
+		for(uint32 p : candidates) {
+			for(uint32 f : newFaces) {
+				float dist = faces[f].normal.dot(points[p]) - faces[f].offset;
+				if(dist > epsilon) {
+					if(faces[f].outside.empty() || dist > faces[f].farthestDist) {
+						faces[f].farthest = p;
+						faces[f].farthestDist = dist;
+					}
+					faces[f].outside.push_back(p);
+					break;
+				}
+			}
+		}
+	}
+
+	//returns false if the points are degenerate (fewer than 4 or all coplanar)
+	//maxVertices of 0 means no simplification
+	inline bool Quickhull(const std::vector<Vector3>& points, std::vector<Vector3>& outVertices, std::vector<uint32>& outIndices, uint32 maxVertices = 0) {
+		outVertices.clear();
+		outIndices.clear();
+		if(points.size() < 4) { return false; }
+
+		//scale the epsilon to the size of the point cloud
+		uint32 extremes[6] = { 0, 0, 0, 0, 0, 0 };
+		for(uint32 i = 0; i < points.size(); ++i) {
+			const Vector3& p = points[i];
+			if(p.x < points[extremes[0]].x) { extremes[0] = i; }
+			if(p.x > points[extremes[1]].x) { extremes[1] = i; }
+			if(p.y < points[extremes[2]].y) { extremes[2] = i; }
+			if(p.y > points[extremes[3]].y) { extremes[3] = i; }
+			if(p.z < points[extremes[4]].z) { extremes[4] = i; }
+			if(p.z > points[extremes[5]].z) { extremes[5] = i; }
+		}
+		float size = fmaxf(points[extremes[1]].x - points[extremes[0]].x, fmaxf(points[extremes[3]].y - points[extremes[2]].y, points[extremes[5]].z - points[extremes[4]].z));
+		float epsilon = size * 1e-5f;
+
+	//// initial tetrahedron ////
+
+		//the two extreme points farthest apart
+		uint32 a = 0, b = 0;
+		float best = -1;
+		for(int i = 0; i < 6; ++i) {
+			for(int j = i + 1; j < 6; ++j) {
+				float d = (points[extremes[i]] - points[extremes[j]]).mag();
+				if(d > best) { best = d; a = extremes[i]; b = extremes[j]; }
+			}
+		}
+		if(best <= epsilon) { return false; }
+
+		//the point farthest from that line
+		uint32 c = 0;
+		Vector3 line = (points[b] - points[a]) / (points[b] - points[a]).mag();
+		best = -1;
+		for(uint32 i = 0; i < points.size(); ++i) {
+			float d = (points[i] - points[a]).trueCross(line).mag();
+			if(d > best) { best = d; c = i; }
+		}
+		if(best <= epsilon) { return false; }
+
+		//the point farthest from that plane
+		uint32 d = 0;
+		best = -1;
+		Vector3 planeNormal = PlaneNormal(points[a], points[b], points[c]);
+		for(uint32 i = 0; i < points.size(); ++i) {
+			float dist = fabs(planeNormal.dot(points[i] - points[a]));
+			if(dist > best) { best = dist; d = i; }
+		}
+		if(best <= epsilon) { return false; }
+
+		//wind the base away from the apex so every face points outward
+		if(planeNormal.dot(points[d] - points[a]) > 0) { std::swap(b, c); }
+
+		std::vector<HullFace> faces;
+		faces.reserve(64);
+		std::unordered_map<unsigned long long, uint32> edges; //directed edge -> face that owns it
+		uint32 initial[4][3] = { { a, b, c }, { a, d, b }, { b, d, c }, { c, d, a } };
+		std::vector<uint32> newFaces;
+		for(int i = 0; i < 4; ++i) {
+			HullFace f;
+			f.v[0] = initial[i][0]; f.v[1] = initial[i][1]; f.v[2] = initial[i][2];
+			SetFacePlane(f, points);
+			for(int e = 0; e < 3; ++e) { edges[EdgeKey(f.v[e], f.v[(e + 1) % 3])] = i; }
+			faces.push_back(f);
+			newFaces.push_back(i);
+		}
+
+		std::vector<bool> used(points.size(), false);
+		used[a] = used[b] = used[c] = used[d] = true;
+		uint32 vertexCount = 4;
+
+		std::vector<uint32> candidates;
+		candidates.reserve(points.size());
+		for(uint32 i = 0; i < points.size(); ++i) { if(!used[i]) candidates.push_back(i); }
+		AssignOutside(faces, newFaces, candidates, points, epsilon);
+
+	//// expansion ////
+
+		std::vector<uint32> alive = newFaces; //compacted every iteration so dead faces arent rescanned
+		std::vector<uint32> visible, stack;
+		std::vector<std::pair<uint32, uint32>> horizon;
+		std::vector<uint32> visited(faces.size(), 0);
+		uint32 iteration = 0;
+		while(maxVertices == 0 || vertexCount < maxVertices) {
+			//the point farthest out from any face
+			int32 face = -1;
+			best = epsilon;
+			for(uint32 f : alive) {
+				if(!faces[f].outside.empty() && faces[f].farthestDist > best) { best = faces[f].farthestDist; face = f; }
+			}
+			if(face == -1) { break; }
+			uint32 eye = faces[face].farthest;
+			++iteration;
+
+			//flood out from that face across every face the eye can see, the edges where it stops form the horizon
+			//flooding rather than testing every face keeps the visible region connected when points are nearly coplanar
+			visible.clear();
+			horizon.clear();
+			stack.clear();
+			stack.push_back(face);
+			visited[face] = iteration;
+			faces[face].alive = false;
+			while(!stack.empty()) {
+				uint32 f = stack.back(); stack.pop_back();
+				visible.push_back(f);
+				for(int e = 0; e < 3; ++e) {
+					uint32 g = edges[EdgeKey(faces[f].v[(e + 1) % 3], faces[f].v[e])];
+					if(visited[g] != iteration) {
+						visited[g] = iteration;
+						if(faces[g].normal.dot(points[eye]) - faces[g].offset > epsilon) {
+							faces[g].alive = false;
+							stack.push_back(g);
+						}
+					}
+				}
+			}
+
+			//float error on near coplanar faces can leave the horizon with a face the eye cant quite see walled in by
+			//visible ones, or with a new face that would fold back over its neighbour. both get removed along with
+			//the visible faces until the horizon is a single loop that gives a convex cone
+			bool grown = true;
+			while(grown) {
+				grown = false;
+				horizon.clear();
+				for(uint32 i = 0; i < visible.size(); ++i) {
+					for(int e = 0; e < 3; ++e) {
+						uint32 from = faces[visible[i]].v[e], to = faces[visible[i]].v[(e + 1) % 3];
+						uint32 g = edges[EdgeKey(to, from)];
+						if(!faces[g].alive) continue;
+
+						bool enclosed = true;
+						uint32 opposite = 0;
+						for(int k = 0; k < 3; ++k) {
+							if(faces[edges[EdgeKey(faces[g].v[(k + 1) % 3], faces[g].v[k])]].alive) { enclosed = false; }
+							if(faces[g].v[k] != from && faces[g].v[k] != to) { opposite = faces[g].v[k]; }
+						}
+						HullFace cone;
+						cone.v[0] = from; cone.v[1] = to; cone.v[2] = eye;
+						SetFacePlane(cone, points);
+						if(enclosed || cone.normal.dot(points[opposite]) - cone.offset > epsilon) {
+							faces[g].alive = false;
+							visible.push_back(g);
+							grown = true;
+						} else {
+							horizon.push_back(std::make_pair(from, to));
+						}
+					}
+				}
+			}
+
+			candidates.clear();
+			for(uint32 f : visible) {
+				for(uint32 p : faces[f].outside) { if(p != eye) candidates.push_back(p); }
+				std::vector<uint32>().swap(faces[f].outside);
+			}
+
+			newFaces.clear();
+			for(auto& edge : horizon) {
+				HullFace f;
+				f.v[0] = edge.first; f.v[1] = edge.second; f.v[2] = eye;
+				SetFacePlane(f, points);
+				uint32 index = faces.size();
+				for(int e = 0; e < 3; ++e) { edges[EdgeKey(f.v[e], f.v[(e + 1) % 3])] = index; }
+				newFaces.push_back(index);
+				faces.push_back(f);
+				visited.push_back(0);
+			}
+			AssignOutside(faces, newFaces, candidates, points, epsilon);
+			used[eye] = true;
+			++vertexCount;
+
+			uint32 count = 0;
+			for(uint32 f : alive) { if(faces[f].alive) alive[count++] = f; }
+			alive.resize(count);
+			alive.insert(alive.end(), newFaces.begin(), newFaces.end());
+		}
+
+	//// output ////
+
+		std::vector<int32> remap(points.size(), -1);
+		for(HullFace& f : faces) {
+			if(!f.alive) continue;
+			for(int i = 0; i < 3; ++i) {
+				if(remap[f.v[i]] == -1) {
+					remap[f.v[i]] = outVertices.size();
+					outVertices.push_back(points[f.v[i]]);
+				}
+				outIndices.push_back(remap[f.v[i]]);
+			}
+		}
+		return true;
+	}
+
+//// Disk Cache ////
+
+	//the cache lives next to the source file with its extension swapped, eg. objects/bmonkey.obj -> objects/bmonkey.hull
+	inline std::string CachePath(const std::string& sourcePath) {
+		size_t dot = sourcePath.find_last_of('.');
+		return (dot == std::string::npos ? sourcePath : sourcePath.substr(0, dot)) + ".hull";
+	}
+
+	//fnv-1a over the source points, so an edited source rebuilds the cache even if its point count didnt change
+	inline unsigned long long SourceHash(const std::vector<Vector3>& points) {
+		unsigned long long hash = 14695981039346656037ull;
+		for(const Vector3& p : points) {
+			const float coords[3] = { p.x, p.y, p.z };
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(coords);
+			for(size_t i = 0; i < sizeof(coords); ++i) {
+				hash ^= bytes[i];
+				hash *= 1099511628211ull;
+			}
+		}
+		return hash;
+	}
+
+	//the header stores what the hull was built from, so a changed source or vertex limit rebuilds it
+	//a cache with faces pointing past its vertices is treated as stale too
+	inline bool LoadCache(const std::string& path, unsigned long long sourceHash, uint32 maxVertices, std::vector<Vector3>& vertices, std::vector<uint32>& indices) {
+		std::ifstream f(path);
+		if(!f.is_open()) { return false; }
+
+		std::string tag;
+		unsigned long long cachedHash = 0;
+		uint32 cachedMax = 0;
+		f >> tag >> cachedHash >> cachedMax;
+		if(!f || tag != "hull" || cachedHash != sourceHash || cachedMax != maxVertices) { return false; }
+
+		vertices.clear();
+		indices.clear();
+		while(f >> tag) {
+			if(tag == "v") {
+				Vector3 v;
+				f >> v.x >> v.y >> v.z;
+				vertices.push_back(v);
+			} else if(tag == "f") {
+				uint32 a, b, c;
+				f >> a >> b >> c;
+				indices.push_back(a); indices.push_back(b); indices.push_back(c);
+			}
+			if(!f) { return false; }
+		}
+		for(uint32 index : indices) {
+			if(index >= vertices.size()) { return false; }
+		}
+		return vertices.size() >= 4 && indices.size() >= 12;
+	}
+
+	inline void SaveCache(const std::string& path, unsigned long long sourceHash, uint32 maxVertices, const std::vector<Vector3>& vertices, const std::vector<uint32>& indices) {
+		std::ofstream f(path);
+		if(!f.is_open()) { return; }
+		f << "hull " << sourceHash << " " << maxVertices << "\n";
+		for(const Vector3& v : vertices) { f << "v " << v.x << " " << v.y << " " << v.z << "\n"; }
+		for(size_t i = 0; i + 2 < indices.size(); i += 3) { f << "f " << indices[i] << " " << indices[i+1] << " " << indices[i+2] << "\n"; }
+	}
+
+	//loads the hull from the cache next to sourcePath if its up to date, otherwise builds it and writes the cache
+	inline bool FromCachedSource(const std::string& sourcePath, const std::vector<Vector3>& points, uint32 maxVertices,
+								 std::vector<Vector3>& vertices, std::vector<uint32>& indices) {
+		std::string cache = CachePath(sourcePath);
+		unsigned long long sourceHash = SourceHash(points);
+		if(LoadCache(cache, sourceHash, maxVertices, vertices, indices)) { return true; }
+		if(!Quickhull(points, vertices, indices, maxVertices)) { return false; }
+		SaveCache(cache, sourceHash, maxVertices, vertices, indices);
+		return true;
+	}
+};
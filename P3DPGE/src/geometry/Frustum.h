@@ -0,0 +1,56 @@
+#pragma once
+#include "../math/Math.h"
+
+//the six planes bounding what a perspective camera can see, normals point inwards
+//a point p is inside a plane when normal.dot(p) + distance >= 0
+struct Frustum {
+	//prefixed since windows.h defines NEAR and FAR
+	enum { PLANE_LEFT, PLANE_RIGHT, PLANE_BOTTOM, PLANE_TOP, PLANE_NEAR, PLANE_FAR, PLANE_COUNT };
+
+	Vector3 normals[PLANE_COUNT];
+	float distances[PLANE_COUNT];
+
+	Frustum() {}
+
+	//pulls the planes out of the combined matrix (gribb-hartmann), since we use row vectors
+	//clip = v * viewProj so each clip component is a dot product with a column
+	//the projection maps z to [0, w] so the near plane is just the z column
+	Frustum(const Matrix4& viewProj) {
+		const float* m = viewProj.data;
+		auto column = [&](int c) { return Vector4(m[c], m[4 + c], m[8 + c], m[12 + c]); };
+		Vector4 x = column(0), y = column(1), z = column(2), w = column(3);
+
+		SetPlane(PLANE_LEFT,   w + x);
+		SetPlane(PLANE_RIGHT,  w - x);
+		SetPlane(PLANE_BOTTOM, w + y);
+		SetPlane(PLANE_TOP,    w - y);
+		SetPlane(PLANE_NEAR,   z);
+		SetPlane(PLANE_FAR,    w - z);
+	}
+
+	void SetPlane(int i, const Vector4& plane) {
+		float length = sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		if(length == 0) { length = 1; }
+		normals[i] = Vector3(plane.x, plane.y, plane.z) / length;
+		distances[i] = plane.w / length;
+	}
+
+	//true if the sphere is entirely behind at least one plane
+	bool SphereOutside(const Vector3& center, float radius) const {
+		for(int i = 0; i < PLANE_COUNT; ++i) {
+			if(normals[i].dot(center) + distances[i] < -radius) { return true; }
+		}
+		return false;
+	}
+
+	//true if the box is entirely behind at least one plane, tests the corner furthest along each plane's normal
+	//boxes near a frustum corner can still pass when they're outside, which only costs the triangle tests
+	bool AABBOutside(const Vector3& min, const Vector3& max) const {
+		for(int i = 0; i < PLANE_COUNT; ++i) {
+			const Vector3& n = normals[i];
+			Vector3 positive((n.x >= 0) ? max.x : min.x, (n.y >= 0) ? max.y : min.y, (n.z >= 0) ? max.z : min.z);
+			if(n.dot(positive) + distances[i] < 0) { return true; }
+		}
+		return false;
+	}
+};
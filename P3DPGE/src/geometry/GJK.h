@@ -0,0 +1,257 @@
+#pragma once
+#include "../math/Math.h"
+
+#include <vector>
+
+//Gilbert-Johnson-Keerthi intersection test with the Expanding Polytope Algorithm for penetration depth
+//works on any convex shape that can give its farthest point along a direction, so new collider shapes
+//only need a support function
+//ref: https://caseymuratori.com/blog_0003
+namespace GJK {
+
+	//Vector3's == has a tolerance, polytope vertices are exact copies of support points so they can be compared exactly
+	inline bool Same(const Vector3& a, const Vector3& b) {
+		return a.x == b.x && a.y == b.y && a.z == b.z;
+	}
+
+	//Vector3::normalized() leaves vectors within .001 of zero alone, which search directions easily are
+	inline Vector3 Normalize(const Vector3& v) {
+		float length = v.mag();
+		return (length > 0) ? v / length : v;
+	}
+
+//// Support Shapes ////
+
+	struct Sphere {
+		Vector3 center;
+		float radius;
+
+		Sphere(Vector3 center, float radius) : center(center), radius(radius) {}
+
+		Vector3 Support(const Vector3& dir) const {
+			return center + Normalize(dir) * radius;
+		}
+	};
+
+	//oriented box, the rotation's rows are the box's axes in world space
+	struct Box {
+		Vector3 center;
+		Vector3 axes[3];
+		Vector3 halfDims;
+
+		Box(Vector3 center, Matrix3 rotation, Vector3 halfDims) : center(center), halfDims(halfDims) {
+			axes[0] = Vector3::UNITX * rotation;
+			axes[1] = Vector3::UNITY * rotation;
+			axes[2] = Vector3::UNITZ * rotation;
+		}
+
+		Vector3 Support(const Vector3& dir) const {
+			return center
+				+ axes[0] * (dir.dot(axes[0]) > 0 ? halfDims.x : -halfDims.x)
+				+ axes[1] * (dir.dot(axes[1]) > 0 ? halfDims.y : -halfDims.y)
+				+ axes[2] * (dir.dot(axes[2]) > 0 ? halfDims.z : -halfDims.z);
+		}
+	};
+
+	//convex point set in local space, eg. a ConvexPolyCollider's hull vertices
+	struct Hull {
+		const std::vector<Vector3>* vertices;
+		Matrix3 rotation;
+		Matrix3 inverseRotation;
+		Vector3 position;
+
+		Hull(const std::vector<Vector3>* vertices, Matrix3 rotation, Vector3 position)
+			: vertices(vertices), rotation(rotation), inverseRotation(rotation.Transpose()), position(position) {}
+
+		Vector3 Support(const Vector3& dir) const {
+			Vector3 local = dir * inverseRotation;
+			const Vector3* best = &(*vertices)[0];
+			float bestDot = best->dot(local);
+			for(const Vector3& v : *vertices) {
+				float d = v.dot(local);
+				if(d > bestDot) { bestDot = d; best = &v; }
+			}
+			return *best * rotation + position;
+		}
+	};
+
+	//single triangle, used to collide convex shapes against a mesh one triangle at a time
+	struct Triangle {
+		Vector3 p[3];
+
+		Triangle(const Vector3& a, const Vector3& b, const Vector3& c) {
+			p[0] = a; p[1] = b; p[2] = c;
+		}
+
+		Vector3 Support(const Vector3& dir) const {
+			float d0 = p[0].dot(dir), d1 = p[1].dot(dir), d2 = p[2].dot(dir);
+			return (d0 >= d1 && d0 >= d2) ? p[0] : (d1 >= d2 ? p[1] : p[2]);
+		}
+	};
+
+//// Intersection ////
+
+	//support point of the minkowski difference a - b
+	template<class A, class B>
+	inline Vector3 Support(const A& a, const B& b, const Vector3& dir) {
+		return a.Support(dir) - b.Support(-dir);
+	}
+
+	//reduces the simplex to the feature closest to the origin and points dir at the origin from it
+	//the newest point is always simplex[0], returns true once the simplex encloses the origin
+	inline bool DoSimplex(Vector3 simplex[4], int& count, Vector3& dir) {
+		Vector3 a = simplex[0];
+		Vector3 ao = -a;
+		switch(count) {
+			case 2: {
+				Vector3 ab = simplex[1] - a;
+				if(ab.dot(ao) > 0) {
+					dir = ab.trueCross(ao).trueCross(ab);
+					//the origin is on the line, any perpendicular works
+					if(dir.mag() < 1e-12f) { dir = ab.trueCross((fabs(ab.x) < fabs(ab.y)) ? Vector3::UNITX : Vector3::UNITY); }
+				} else {
+					count = 1;
+					dir = ao;
+				}
+				return false;
+			}
+			case 3: {
+				Vector3 b = simplex[1], c = simplex[2];
+				Vector3 ab = b - a, ac = c - a;
+				Vector3 abc = ab.trueCross(ac);
+				if(abc.trueCross(ac).dot(ao) > 0) {
+					if(ac.dot(ao) > 0) {
+						simplex[1] = c;
+						count = 2;
+						dir = ac.trueCross(ao).trueCross(ac);
+						return false;
+					}
+					count = 2;
+					return DoSimplex(simplex, count, dir);
+				}
+				if(ab.trueCross(abc).dot(ao) > 0) {
+					count = 2;
+					return DoSimplex(simplex, count, dir);
+				}
+				if(abc.dot(ao) > 0) {
+					dir = abc;
+				} else {
+					simplex[1] = c;
+					simplex[2] = b;
+					dir = -abc;
+				}
+				return false;
+			}
+			case 4: {
+				Vector3 b = simplex[1], c = simplex[2], d = simplex[3];
+				Vector3 ab = b - a, ac = c - a, ad = d - a;
+				if(ab.trueCross(ac).dot(ao) > 0) {
+					count = 3;
+					return DoSimplex(simplex, count, dir);
+				}
+				if(ac.trueCross(ad).dot(ao) > 0) {
+					simplex[1] = c; simplex[2] = d;
+					count = 3;
+					return DoSimplex(simplex, count, dir);
+				}
+				if(ad.trueCross(ab).dot(ao) > 0) {
+					simplex[1] = d; simplex[2] = b;
+					count = 3;
+					return DoSimplex(simplex, count, dir);
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//returns true if the shapes overlap, the enclosing tetrahedron is left in simplex for EPA
+	template<class A, class B>
+	inline bool Intersect(const A& a, const B& b, Vector3 simplex[4], Vector3 initialDir = Vector3::UNITX) {
+		Vector3 dir = (initialDir.mag() > 1e-12f) ? initialDir : Vector3::UNITX;
+		simplex[0] = Support(a, b, dir);
+		int count = 1;
+		dir = -simplex[0];
+		for(int i = 0; i < 64; ++i) {
+			if(dir.mag() < 1e-12f) { dir = Vector3::UNITY; } //touching, nudge the search off the origin
+			Vector3 p = Support(a, b, dir);
+			if(p.dot(dir) < 0) { return false; }
+			simplex[3] = simplex[2]; simplex[2] = simplex[1]; simplex[1] = simplex[0];
+			simplex[0] = p;
+			++count;
+			if(DoSimplex(simplex, count, dir)) { return true; }
+		}
+		return false;
+	}
+
+//// Penetration ////
+
+	struct EPAFace {
+		Vector3 v[3];
+		Vector3 normal;
+		float distance;
+	};
+
+	inline EPAFace MakeFace(const Vector3& a, const Vector3& b, const Vector3& c) {
+		EPAFace f;
+		f.v[0] = a; f.v[1] = b; f.v[2] = c;
+		f.normal = Normalize((b - a).trueCross(c - a));
+		f.distance = f.normal.dot(a);
+		//the origin is inside the polytope so every face should point away from it
+		if(f.distance < 0) {
+			std::swap(f.v[1], f.v[2]);
+			f.normal = -f.normal;
+			f.distance = -f.distance;
+		}
+		return f;
+	}
+
+	//expands the tetrahedron GJK ended with out to the surface of the minkowski difference until the face
+	//closest to the origin stops moving; normal points from a towards b, moving b by normal * depth separates them
+	template<class A, class B>
+	inline void Penetration(const A& a, const B& b, const Vector3 simplex[4], Vector3& normal, float& depth) {
+		std::vector<EPAFace> faces;
+		faces.reserve(32);
+		faces.push_back(MakeFace(simplex[0], simplex[1], simplex[2]));
+		faces.push_back(MakeFace(simplex[0], simplex[2], simplex[3]));
+		faces.push_back(MakeFace(simplex[0], simplex[3], simplex[1]));
+		faces.push_back(MakeFace(simplex[1], simplex[3], simplex[2]));
+
+		std::vector<std::pair<Vector3, Vector3>> edges;
+		for(int iteration = 0; iteration < 64; ++iteration) {
+			uint32 closest = 0;
+			for(uint32 i = 1; i < faces.size(); ++i) {
+				if(faces[i].distance < faces[closest].distance) { closest = i; }
+			}
+			normal = faces[closest].normal;
+			depth = faces[closest].distance;
+			Vector3 p = Support(a, b, normal);
+			if(p.dot(normal) - depth < 1e-4f) { return; }
+
+			//remove every face the new point can see, keeping the edges that arent shared between them
+			edges.clear();
+			for(uint32 i = 0; i < faces.size();) {
+				if(faces[i].normal.dot(p - faces[i].v[0]) > 0) {
+					for(int e = 0; e < 3; ++e) {
+						Vector3 from = faces[i].v[e], to = faces[i].v[(e + 1) % 3];
+						bool shared = false;
+						for(uint32 j = 0; j < edges.size(); ++j) {
+							if(Same(edges[j].first, to) && Same(edges[j].second, from)) {
+								edges.erase(edges.begin() + j);
+								shared = true;
+								break;
+							}
+						}
+						if(!shared) { edges.push_back(std::make_pair(from, to)); }
+					}
+					faces[i] = faces.back();
+					faces.pop_back();
+				} else {
+					++i;
+				}
+			}
+			if(edges.empty()) { return; } //numerically stuck, take the last closest face
+			for(auto& edge : edges) { faces.push_back(MakeFace(edge.first, edge.second, p)); }
+		}
+	}
+};
@@ -22,4 +22,72 @@ namespace Geometry {
 			fmaxf(center.y - halfDims.z, fminf(target.z, center.z + halfDims.z)));
 	}
 
+	//from Real-Time Collision Detection by Christer Ericson, 5.1.5
+	inline Vector3 ClosestPointOnTriangle(Vector3 a, Vector3 b, Vector3 c, Vector3 target) {
+		Vector3 ab = b - a;
+		Vector3 ac = c - a;
+		Vector3 ap = target - a;
+		float d1 = ab.dot(ap);
+		float d2 = ac.dot(ap);
+		if(d1 <= 0.f && d2 <= 0.f) { return a; }
+
+		Vector3 bp = target - b;
+		float d3 = ab.dot(bp);
+		float d4 = ac.dot(bp);
+		if(d3 >= 0.f && d4 <= d3) { return b; }
+
+		float vc = d1*d4 - d3*d2;
+		if(vc <= 0.f && d1 >= 0.f && d3 <= 0.f) { return a + ab * (d1 / (d1 - d3)); }
+
+		Vector3 cp = target - c;
+		float d5 = ab.dot(cp);
+		float d6 = ac.dot(cp);
+		if(d6 >= 0.f && d5 <= d6) { return c; }
+
+		float vb = d5*d2 - d1*d6;
+		if(vb <= 0.f && d2 >= 0.f && d6 <= 0.f) { return a + ac * (d2 / (d2 - d6)); }
+
+		float va = d3*d6 - d5*d4;
+		if(va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f) { return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))); }
+
+		float denom = 1.f / (va + vb + vc);
+		return a + ab * (vb * denom) + ac * (vc * denom);
+	}
+
+	//separating axis test between a triangle and an oriented box with the given unit axes
+	//returns false if they dont overlap, otherwise the direction to move the box and how far along it
+	inline bool TriangleBoxPenetration(Vector3 a, Vector3 b, Vector3 c, Vector3 center, Vector3 axes[3], Vector3 halfDims, Vector3& normal, float& depth) {
+		Vector3 v[3] = { a - center, b - center, c - center };
+		Vector3 e[3] = { v[1] - v[0], v[2] - v[1], v[0] - v[2] };
+		float h[3] = { halfDims.x, halfDims.y, halfDims.z };
+
+		Vector3 tests[13];
+		int testCount = 0;
+		for(int i = 0; i < 3; ++i) { tests[testCount++] = axes[i]; }
+		tests[testCount++] = e[0].trueCross(e[1]);
+		for(int i = 0; i < 3; ++i) {
+			for(int j = 0; j < 3; ++j) { tests[testCount++] = axes[i].trueCross(e[j]); }
+		}
+
+		depth = INFINITY;
+		for(int i = 0; i < testCount; ++i) {
+			float length = tests[i].mag();
+			if(length < 1e-6f) { continue; } //parallel edges dont give an axis
+			Vector3 axis = tests[i] / length;
+
+			float p0 = v[0].dot(axis), p1 = v[1].dot(axis), p2 = v[2].dot(axis);
+			float tmin = fminf(p0, fminf(p1, p2));
+			float tmax = fmaxf(p0, fmaxf(p1, p2));
+			float r = h[0] * fabs(axes[0].dot(axis)) + h[1] * fabs(axes[1].dot(axis)) + h[2] * fabs(axes[2].dot(axis));
+			if(tmin > r || tmax < -r) { return false; }
+
+			//the box can leave either side of the triangle's interval, take the shorter way out
+			float down = r - tmin;
+			float up = tmax + r;
+			if(down < depth) { depth = down; normal = -axis; }
+			if(up < depth)   { depth = up;   normal = axis; }
+		}
+		return true;
+	}
+
 };
\ No newline at end of file
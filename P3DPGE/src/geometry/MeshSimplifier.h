@@ -0,0 +1,326 @@
+#pragma once
+#include "../math/Vector3.h"
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <unordered_map>
+
+//quadric error metric simplification (garland-heckbert), repeatedly collapses the edge whose merged vertex
+//moves the surface the least, producing coarser copies of a mesh for drawing when its small on screen
+namespace MeshSimplifier {
+
+	//a coarser copy of a mesh, triangles keep the corner order of the triangle they came from
+	struct Level {
+		std::vector<Vector3> vertices;
+		std::vector<Vector3> uvs;		//texture coordinates per vertex
+		std::vector<uint32> colors;		//color per vertex, every corner of a triangle has the same one
+		std::vector<uint32> indices;
+		float error = 0; //how far the surface may have moved from the original, in local units
+	};
+
+	//sum of squared distances to a set of planes as a symmetric 4x4 matrix, only the upper half is stored
+	struct Quadric {
+		double a2 = 0, ab = 0, ac = 0, ad = 0;
+		double b2 = 0, bc = 0, bd = 0;
+		double c2 = 0, cd = 0;
+		double d2 = 0;
+
+		Quadric() {}
+
+		//the plane ax + by + cz + d = 0 with a unit normal
+		Quadric(double a, double b, double c, double d) :
+			a2(a * a), ab(a * b), ac(a * c), ad(a * d),
+			b2(b * b), bc(b * c), bd(b * d),
+			c2(c * c), cd(c * d),
+			d2(d * d) {}
+
+		void operator+=(const Quadric& q) {
+			a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+			b2 += q.b2; bc += q.bc; bd += q.bd;
+			c2 += q.c2; cd += q.cd;
+			d2 += q.d2;
+		}
+
+		double Evaluate(const Vector3& v) const {
+			double x = v.x, y = v.y, z = v.z;
+			return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+				 + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+				 + c2 * z * z + 2 * cd * z
+				 + d2;
+		}
+
+		//the point with the least error, false when there isnt a single one (flat or straight regions)
+		bool Optimal(Vector3& out) const {
+			double det = a2 * (b2 * c2 - bc * bc) - ab * (ab * c2 - bc * ac) + ac * (ab * bc - b2 * ac);
+			double scale = a2 + b2 + c2;
+			if(fabs(det) <= 1e-9 * scale * scale * scale) { return false; }
+
+			//cramer's rule on the upper 3x3 against -(ad, bd, cd)
+			double x = -(ad * (b2 * c2 - bc * bc) - ab * (bd * c2 - bc * cd) + ac * (bd * bc - b2 * cd)) / det;
+			double y = -(a2 * (bd * c2 - cd * bc) - ad * (ab * c2 - bc * ac) + ac * (ab * cd - bd * ac)) / det;
+			double z = -(a2 * (b2 * cd - bc * bd) - ab * (ab * cd - bd * ac) + ad * (ab * bc - b2 * ac)) / det;
+			out = Vector3((float)x, (float)y, (float)z);
+			return true;
+		}
+	};
+
+	//an edge collapse waiting in the queue, stale once either vertex's stamp has moved on
+	struct Collapse {
+		double cost;
+		uint32 keep, remove;
+		uint32 keepStamp, removeStamp;
+		Vector3 position;
+		Vector3 uv;
+
+		bool operator>(const Collapse& c) const { return cost > c.cost; }
+	};
+
+	inline Vector3 FaceNormal(const Vector3& a, const Vector3& b, const Vector3& c) {
+		return (b - a).trueCross(c - a);
+	}
+
+	inline unsigned long long EdgeKey(uint32 a, uint32 b) {
+		if(a > b) { std::swap(a, b); }
+		return ((unsigned long long)a << 32) | b;
+	}
+
+	//works on a copy of the mesh, collapsing edges until each target triangle count is reached
+	//and snapshotting the result as a level, stops early once no more edges can collapse
+	//vertices are expected to be split wherever their texture coordinates or color change, those seams are
+	//locked so a collapse never drags one side's attributes across the other
+	struct Simplifier {
+		std::vector<Vector3> positions;
+		std::vector<Vector3> uvs;
+		std::vector<uint32> colors;
+		std::vector<bool> locked;		//per vertex, on a seam so it never moves
+		std::vector<Quadric> quadrics;
+		std::vector<uint32> stamps;		//per vertex, bumped whenever it changes
+		std::vector<bool> removed;		//per vertex
+		std::vector<std::vector<uint32>> vertexTriangles; //may hold dead triangles, they're skipped
+		std::vector<uint32> corners;	//3 per triangle
+		std::vector<bool> dead;			//per triangle
+		uint32 liveTriangles = 0;
+		double maxCost = 0;
+		std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+
+		Simplifier(const std::vector<Vector3>& vertices, const std::vector<Vector3>& uvs, const std::vector<uint32>& colors,
+				   const std::vector<uint32>& indices) {
+			positions = vertices;
+			this->uvs = uvs;
+			this->colors = colors;
+			corners = indices;
+			uint32 triangleCount = (uint32)indices.size() / 3;
+			quadrics.resize(vertices.size());
+			stamps.resize(vertices.size(), 0);
+			removed.resize(vertices.size(), false);
+			vertexTriangles.resize(vertices.size());
+			dead.resize(triangleCount, false);
+			liveTriangles = triangleCount;
+
+			//a seam is wherever two vertices sit at the same point, sorting by position puts them next to each other
+			locked.resize(vertices.size(), false);
+			std::vector<uint32> order(vertices.size());
+			for(uint32 i = 0; i < order.size(); ++i) { order[i] = i; }
+			auto less = [&](uint32 a, uint32 b) {
+				const Vector3& pa = positions[a];
+				const Vector3& pb = positions[b];
+				if(pa.x != pb.x) return pa.x < pb.x;
+				if(pa.y != pb.y) return pa.y < pb.y;
+				return pa.z < pb.z;
+			};
+			std::sort(order.begin(), order.end(), less);
+			for(size_t i = 1; i < order.size(); ++i) {
+				if(!less(order[i - 1], order[i])) { locked[order[i - 1]] = locked[order[i]] = true; }
+			}
+
+			//each vertex starts with the planes of the triangles around it
+			std::unordered_map<unsigned long long, uint32> edgeUses;
+			for(uint32 t = 0; t < triangleCount; ++t) {
+				const uint32* c = &corners[3 * t];
+				Vector3 n = FaceNormal(positions[c[0]], positions[c[1]], positions[c[2]]);
+				float length = n.mag();
+				if(length > 0) {
+					n = n / length;
+					Quadric q(n.x, n.y, n.z, -n.dot(positions[c[0]]));
+					for(int k = 0; k < 3; ++k) { quadrics[c[k]] += q; }
+				}
+				for(int k = 0; k < 3; ++k) {
+					vertexTriangles[c[k]].push_back(t);
+					edgeUses[EdgeKey(c[k], c[(k + 1) % 3])]++;
+				}
+			}
+
+			//edges on only one triangle get a plane standing up from them, so open borders dont shrink inwards
+			for(uint32 t = 0; t < triangleCount; ++t) {
+				const uint32* c = &corners[3 * t];
+				Vector3 n = FaceNormal(positions[c[0]], positions[c[1]], positions[c[2]]);
+				for(int k = 0; k < 3; ++k) {
+					if(edgeUses[EdgeKey(c[k], c[(k + 1) % 3])] != 1) { continue; }
+					Vector3 edge = positions[c[(k + 1) % 3]] - positions[c[k]];
+					Vector3 border = edge.trueCross(n);
+					float length = border.mag();
+					if(length == 0) { continue; }
+					border = border / length;
+					Quadric q(border.x, border.y, border.z, -border.dot(positions[c[k]]));
+					quadrics[c[k]] += q;
+					quadrics[c[(k + 1) % 3]] += q;
+				}
+			}
+
+			for(auto& pair : edgeUses) {
+				QueueCollapse((uint32)(pair.first >> 32), (uint32)(pair.first & 0xFFFFFFFF));
+			}
+		}
+
+		void QueueCollapse(uint32 keep, uint32 remove) {
+			//a locked vertex can only be collapsed onto, and stays where it is
+			if(locked[keep] && locked[remove]) { return; }
+			if(locked[remove]) { std::swap(keep, remove); }
+
+			Quadric q = quadrics[keep];
+			q += quadrics[remove];
+
+			//the optimal point can be far off for nearly flat neighborhoods, the ends and middle are safe fallbacks
+			const Vector3& a = positions[keep];
+			const Vector3& b = positions[remove];
+			Vector3 middle = (a + b) / 2.f;
+			Vector3 position;
+			double cost;
+			if(locked[keep]) {
+				position = a;
+				cost = q.Evaluate(a);
+			} else if(q.Optimal(position) && (position - middle).mag() <= (b - a).mag()) {
+				cost = q.Evaluate(position);
+			} else {
+				position = a;
+				cost = q.Evaluate(a);
+				double costB = q.Evaluate(b);
+				double costMiddle = q.Evaluate(middle);
+				if(costB < cost)		{ position = b;		 cost = costB; }
+				if(costMiddle < cost)	{ position = middle; cost = costMiddle; }
+			}
+
+			//the texture coordinates slide along the edge with the position, both ends are on the same side of any seam
+			Vector3 edge = b - a;
+			float lengthSq = edge.dot(edge);
+			float t = (lengthSq > 0) ? std::min(std::max((position - a).dot(edge) / lengthSq, 0.f), 1.f) : 0.f;
+			Vector3 uv = uvs[keep] + (uvs[remove] - uvs[keep]) * t;
+			queue.push({std::max(cost, 0.0), keep, remove, stamps[keep], stamps[remove], position, uv});
+		}
+
+		//true if moving either end to the new position turns any remaining triangle around it over or into a sliver
+		bool Flips(const Collapse& c) const {
+			uint32 ends[2] = {c.keep, c.remove};
+			for(uint32 end : ends) {
+				for(uint32 t : vertexTriangles[end]) {
+					if(dead[t]) { continue; }
+					const uint32* tc = &corners[3 * t];
+					bool hasKeep = tc[0] == c.keep || tc[1] == c.keep || tc[2] == c.keep;
+					bool hasRemove = tc[0] == c.remove || tc[1] == c.remove || tc[2] == c.remove;
+					if(hasKeep && hasRemove) { continue; } //collapses away
+
+					Vector3 p[3];
+					for(int k = 0; k < 3; ++k) { p[k] = (tc[k] == end) ? c.position : positions[tc[k]]; }
+					Vector3 before = FaceNormal(positions[tc[0]], positions[tc[1]], positions[tc[2]]);
+					Vector3 after = FaceNormal(p[0], p[1], p[2]);
+					if(after.dot(before) <= .2f * after.mag() * before.mag()) { return true; }
+				}
+			}
+			return false;
+		}
+
+		void Apply(const Collapse& c) {
+			positions[c.keep] = c.position;
+			uvs[c.keep] = c.uv;
+			quadrics[c.keep] += quadrics[c.remove];
+			removed[c.remove] = true;
+			stamps[c.keep]++;
+			stamps[c.remove]++;
+			maxCost = std::max(maxCost, c.cost);
+
+			for(uint32 t : vertexTriangles[c.remove]) {
+				if(dead[t]) { continue; }
+				uint32* tc = &corners[3 * t];
+				if(tc[0] == c.keep || tc[1] == c.keep || tc[2] == c.keep) {
+					dead[t] = true;
+					liveTriangles--;
+				} else {
+					for(int k = 0; k < 3; ++k) { if(tc[k] == c.remove) { tc[k] = c.keep; } }
+					vertexTriangles[c.keep].push_back(t);
+				}
+			}
+			vertexTriangles[c.remove].clear();
+
+			//drop dead triangles from the kept vertex's list, then requeue its edges with the merged quadric
+			std::vector<uint32>& around = vertexTriangles[c.keep];
+			around.erase(std::remove_if(around.begin(), around.end(), [&](uint32 t) { return dead[t]; }), around.end());
+			std::vector<uint32> neighbors;
+			for(uint32 t : around) {
+				for(int k = 0; k < 3; ++k) {
+					uint32 v = corners[3 * t + k];
+					if(v != c.keep && std::find(neighbors.begin(), neighbors.end(), v) == neighbors.end()) { neighbors.push_back(v); }
+				}
+			}
+			for(uint32 v : neighbors) { QueueCollapse(c.keep, v); }
+		}
+
+		//collapses until there are at most target triangles or nothing left can collapse
+		void Reduce(uint32 target) {
+			while(liveTriangles > target && !queue.empty()) {
+				Collapse c = queue.top();
+				queue.pop();
+				if(removed[c.keep] || removed[c.remove]) { continue; }
+				if(stamps[c.keep] != c.keepStamp || stamps[c.remove] != c.removeStamp) { continue; }
+				if(Flips(c)) { continue; }
+				Apply(c);
+			}
+		}
+
+		//copies the remaining triangles and the vertices they use
+		void Snapshot(Level& level) const {
+			std::vector<uint32> remap(positions.size(), (uint32)-1);
+			for(uint32 t = 0; t < dead.size(); ++t) {
+				if(dead[t]) { continue; }
+				for(int k = 0; k < 3; ++k) {
+					uint32 v = corners[3 * t + k];
+					if(remap[v] == (uint32)-1) {
+						remap[v] = (uint32)level.vertices.size();
+						level.vertices.push_back(positions[v]);
+						level.uvs.push_back(uvs[v]);
+						level.colors.push_back(colors[v]);
+					}
+					level.indices.push_back(remap[v]);
+				}
+			}
+			//cost is a sum of squared plane distances, so its root bounds the distance to any one plane
+			level.error = (float)sqrt(maxCost);
+		}
+	};
+
+	//fills levels with up to maxLevels copies each with about half the triangles of the one before,
+	//stopping before one would have fewer than minTriangles or once the mesh cant be reduced further
+	//uvs and colors are per vertex like vertices
+	inline void Simplify(const std::vector<Vector3>& vertices, const std::vector<Vector3>& uvs, const std::vector<uint32>& colors,
+						 const std::vector<uint32>& indices, std::vector<Level>& levels, uint32 maxLevels, uint32 minTriangles) {
+		levels.clear();
+		uint32 triangles = (uint32)indices.size() / 3;
+		if(triangles / 2 < minTriangles) { return; }
+
+		Simplifier simplifier(vertices, uvs, colors, indices);
+		for(uint32 i = 0; i < maxLevels; ++i) {
+			uint32 target = triangles >> (i + 1);
+			if(target < minTriangles) { break; }
+
+			uint32 before = simplifier.liveTriangles;
+			simplifier.Reduce(target);
+			if(simplifier.liveTriangles >= before) { break; }
+
+			levels.push_back(Level());
+			simplifier.Snapshot(levels.back());
+
+			//a level that didnt get close to its target has run out of edges, the next one would be the same
+			if(simplifier.liveTriangles > target + target / 2) { break; }
+		}
+	}
+}
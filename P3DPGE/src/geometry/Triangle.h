@@ -12,13 +12,11 @@ struct Triangle {
 	Vector3 tex_points[3];
 	Vector3 proj_tex_points[3];
 
-	Triangle* orig		= nullptr;
 	Entity* e			= nullptr;
 
-	bool is_clip = false;
-
 	Vector3 normal;
-	float area;
+	Vector3 localNormal; //normal of poffsets, MeshSystem rotates it into normal when the mesh moves
+	float area = 0;
 
 	//maybe edges can be cleared when they're not actually needed,
 	//and only spawned when used?
@@ -115,17 +113,25 @@ struct Triangle {
 	}
 
 	Vector3 get_normal() {
-		return (points[1] - points[0]).cross(points[2] - points[0]).yInvert().normalized();
+		return (points[1] - points[0]).trueCross(points[2] - points[0]).normalized();
 	}
 
 	void set_normal() {
-		normal = (points[1] - points[0]).cross(points[2] - points[0]).yInvert().normalized();
+		normal = (points[1] - points[0]).trueCross(points[2] - points[0]).normalized();
+	}
+
+	//the normal and area of the local shape, done once when the mesh is built
+	//the area never changes after that since meshes are only rotated and moved
+	void cache_normal_and_area() {
+		localNormal = (poffsets[1] - poffsets[0]).trueCross(poffsets[2] - poffsets[0]).normalized();
+		normal = localNormal;
+		area = Math::TriangleArea(poffsets[1] - poffsets[0], poffsets[2] - poffsets[0]);
 	}
 
 	Vector3 get_proj_normal() {
 		Vector3 l1 = proj_points[1] - proj_points[0];
 		Vector3 l2 = proj_points[2] - proj_points[0];
-		return l1.cross(l2).yInvert().normalized();
+		return l1.trueCross(l2).normalized();
 	}
 
 	//checks if a triangle contains a point in screen space
@@ -172,7 +178,7 @@ struct Triangle {
 	bool line_intersect(Edge3D* e) {
 		float t = 0;
 
-		Vector3 i = Math::VectorPlaneIntersect(points[0], get_normal(), e->p[0], e->p[1], t);
+		Vector3 i = Math::VectorPlaneIntersect(points[0], normal, e->p[0], e->p[1], t);
 
 		float a1 = Math::TriangleArea(points[0] - i, points[2] - i);
 		float a2 = Math::TriangleArea(points[2] - i, points[1] - i);
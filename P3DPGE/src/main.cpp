@@ -1,10 +1,15 @@
 #pragma once
+//the headless build (CMakeLists.txt) only runs the benchmarks, it has no window, sound or ui
+//and utils/HeadlessEngine.cpp stands in for the engine's implementation
+#ifndef P3DPGE_HEADLESS
 #define OLC_PGE_APPLICATION
+#endif
 #include "internal/olcPixelGameEngine.h"
 
 #define KEYBOARD_LAYOUT_US_UK
 #define DEBUG_P3DPGE
 #include "EntityAdmin.h"
+#include "utils/Benchmark.h"
 
 using namespace olc;
 
@@ -15,6 +20,7 @@ using namespace olc;
 2. Changed PixelGameEngine.pMouseState to public
 */
 
+#ifndef P3DPGE_HEADLESS
 class P3DPGE : public PixelGameEngine {
 public:
 	EntityAdmin entityAdmin;
@@ -45,10 +51,60 @@ public:
 		return true;
 	}
 };
+#endif //P3DPGE_HEADLESS
 
-int main() {
+//the count a benchmark flag was given, false if its not a whole number that fits in a uint32
+inline bool ParseBenchCount(const char* arg, uint32& count) {
+	std::string digits(arg);
+	if(digits.empty() || digits.size() > 9 || digits.find_first_not_of("0123456789") != std::string::npos) { return false; }
+	count = (uint32)std::stoul(digits);
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	//headless benchmarks, prints JSON to stdout and exits without opening a window
+	const char* benchUsage =
+		"usage: P3DPGE -bench_physics [repeat]\n"
+		"       P3DPGE -bench_render [frames] [imagePath]\n"
+		"       P3DPGE -bench_backface [iterations]\n"
+		"       P3DPGE -bench_sampler [passes]\n";
+	if(argc > 1 && std::string(argv[1]).compare(0, 7, "-bench_") == 0) {
+		std::string flag(argv[1]);
+		uint32 count = 0;
+		bool counted = argc > 2 && ParseBenchCount(argv[2], count);
+		if(argc > 2 && !counted) {
+			std::cerr << "\"" << argv[2] << "\" is not a count\n" << benchUsage;
+			return 1;
+		}
+
+		if(flag == "-bench_physics") {
+			std::cout << Benchmark::Physics(counted ? count : 1) << std::endl;
+		} else if(flag == "-bench_render") {
+			//fails with 2 when the frame doesnt match the golden hash or the visibility buffer's frame, for CI
+			bool passed = true;
+			std::cout << Benchmark::Render(counted ? count : 120, 1280, 720, argc > 3 ? argv[3] : "", &passed) << std::endl;
+			if(!passed) {
+				std::cerr << "render regression: the rendered frame doesnt match the golden frame\n";
+				return 2;
+			}
+		} else if(flag == "-bench_backface") {
+			std::cout << Benchmark::BackFace(counted ? count : 100) << std::endl;
+		} else if(flag == "-bench_sampler") {
+			std::cout << Benchmark::Sampler(counted ? count : 20) << std::endl;
+		} else {
+			std::cerr << benchUsage;
+			return 1;
+		}
+		return 0;
+	}
+
+#ifdef P3DPGE_HEADLESS
+	std::cerr << benchUsage;
+	return 1;
+#else
 	srand(time(0));
 	
 	P3DPGE game;
 	if (game.Construct(1280, 720, 1, 1, false, false)) { game.Start(); }
+#endif
 }
\ No newline at end of file
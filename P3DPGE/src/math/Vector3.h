@@ -57,7 +57,8 @@ struct Vector3 {
 	const std::string str2f() const;
 	Vector3 copy() const;
 	float	dot(const Vector3& rhs) const;
-	Vector3 cross(const Vector3& rhs) const;
+	Vector3 cross(const Vector3& rhs) const; //NOTE the y component is negated, most of the engine was built around it
+	Vector3 trueCross(const Vector3& rhs) const; //the standard right handed cross product
 	float	mag() const;
 	void	normalize();
 	Vector3	normalized() const;
@@ -185,6 +186,10 @@ inline Vector3 Vector3::cross(const Vector3& rhs) const {
 	return Vector3(this->y * rhs.z - rhs.y * this->z, this->x * rhs.z - rhs.x * this->z, this->x * rhs.y - rhs.x * this->y);
 }
 
+inline Vector3 Vector3::trueCross(const Vector3& rhs) const {
+	return Vector3(this->y * rhs.z - rhs.y * this->z, rhs.x * this->z - this->x * rhs.z, this->x * rhs.y - rhs.x * this->y);
+}
+
 inline float Vector3::mag() const {
 	return std::sqrt(x * x + y * y + z * z);
 }
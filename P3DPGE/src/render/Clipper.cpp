@@ -0,0 +1,75 @@
+#include "Clipper.h"
+#include "Rasterizer.h"
+
+void ClipPolygonToPlane(const ClipPolygon& in, ClipPolygon& out, const Vector3& planePoint, const Vector3& planeNormal) {
+	out.count = 0;
+	if(in.count == 0) { return; }
+
+	float planeDist = planeNormal.dot(planePoint);
+	const ClipVertex* prev = &in.vertices[in.count - 1];
+	float prevDist = planeNormal.dot(prev->position) - planeDist;
+	for(int32 i = 0; i < in.count; ++i) {
+		const ClipVertex* curr = &in.vertices[i];
+		float currDist = planeNormal.dot(curr->position) - planeDist;
+
+		if((prevDist >= 0) != (currDist >= 0)) {
+			//interpolate from whichever end is inside
+			const ClipVertex* inside  = (prevDist >= 0) ? prev : curr;
+			const ClipVertex* outside = (prevDist >= 0) ? curr : prev;
+			float insideDist  = (prevDist >= 0) ? prevDist : currDist;
+			float outsideDist = (prevDist >= 0) ? currDist : prevDist;
+			float t = insideDist / (insideDist - outsideDist);
+
+			ClipVertex& v = out.vertices[out.count++];
+			v.position = inside->position + (outside->position - inside->position) * t;
+			v.tex = inside->tex + (outside->tex - inside->tex) * t;
+			v.shadow = inside->shadow + (outside->shadow - inside->shadow) * t;
+		}
+		if(currDist >= 0) {
+			out.vertices[out.count++] = *curr;
+		}
+
+		prev = curr;
+		prevDist = currDist;
+	}
+}
+
+GuardBand::GuardBand(float width, float height) {
+	//centered on the screen and as large as the rasterizer allows, but never smaller than the screen
+	//(screens past MAX_EXTENT just fall back to clipping at the borders)
+	//a pixel of slack keeps clipped points that land a hair outside from tipping a triangle over the limit
+	float half = Rasterizer::MAX_EXTENT / 2.f - 1.f;
+	minX = std::min(0.f, width / 2.f - half);
+	minY = std::min(0.f, height / 2.f - half);
+	maxX = std::max(width, width / 2.f + half);
+	maxY = std::max(height, height / 2.f + half);
+}
+
+uint8 GuardBand::Outcode(const Vector3& p, float minX, float minY, float maxX, float maxY) {
+	uint8 code = 0;
+	if(p.x < minX) code |= OUT_LEFT;
+	if(p.x > maxX) code |= OUT_RIGHT;
+	if(p.y < minY) code |= OUT_TOP;
+	if(p.y > maxY) code |= OUT_BOTTOM;
+	return code;
+}
+
+ClipPolygon* GuardBand::Clip(ClipPolygon* polygon, ClipPolygon* scratch, uint8 outcode) const {
+	if(outcode & OUT_LEFT) {
+		ClipPolygonToPlane(*polygon, *scratch, Vector3(minX, 0, 0), Vector3::RIGHT);
+		std::swap(polygon, scratch);
+	}
+	if(outcode & OUT_RIGHT) {
+		ClipPolygonToPlane(*polygon, *scratch, Vector3(maxX, 0, 0), Vector3::LEFT);
+		std::swap(polygon, scratch);
+	}
+	if(outcode & OUT_TOP) {
+		ClipPolygonToPlane(*polygon, *scratch, Vector3(0, minY, 0), Vector3::UP);
+		std::swap(polygon, scratch);
+	}
+	if(outcode & OUT_BOTTOM) {
+		ClipPolygonToPlane(*polygon, *scratch, Vector3(0, maxY, 0), Vector3::DOWN);
+		std::swap(polygon, scratch);
+	}
+	return polygon;
+}
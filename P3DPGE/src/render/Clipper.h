@@ -0,0 +1,38 @@
+#pragma once
+#include "../math/Vector3.h"
+
+//a polygon vertex carried through clipping, the texture and shadow coordinates are interpolated along with the position
+struct ClipVertex {
+	Vector3 position;
+	Vector3 tex;
+	Vector3 shadow;	//position in the shadow map, only used when there is one
+};
+
+//convex polygon kept on the stack, each plane a triangle is clipped against can add at most one vertex
+//so a triangle clipped by the near plane and the four guard band planes never needs more than 8
+struct ClipPolygon {
+	static const int32 MAX_VERTICES = 8;
+	ClipVertex vertices[MAX_VERTICES];
+	int32 count = 0;
+};
+
+//sutherland-hodgman, keeps the part of the polygon where (v - planePoint).dot(planeNormal) >= 0
+//new vertices are always interpolated from the inside end of an edge, so two triangles sharing an edge get the same point
+void ClipPolygonToPlane(const ClipPolygon& in, ClipPolygon& out, const Vector3& planePoint, const Vector3& planeNormal);
+
+//a screen space rect past the viewport that the rasterizer can take triangles from unclipped
+//its sized so anything inside it fits in the rasterizer's fixed point range, so only triangles
+//that reach past it need clipping in screen space
+struct GuardBand {
+	float minX, minY, maxX, maxY;
+
+	GuardBand(float width, float height);
+
+	//bits for which of the rect's sides a point is outside of
+	enum : uint8 { OUT_LEFT = 1, OUT_RIGHT = 2, OUT_TOP = 4, OUT_BOTTOM = 8 };
+	static uint8 Outcode(const Vector3& p, float minX, float minY, float maxX, float maxY);
+
+	//clips the polygon to the sides in outcode, ping-ponging between polygon and scratch
+	//returns whichever of the two holds the result
+	ClipPolygon* Clip(ClipPolygon* polygon, ClipPolygon* scratch, uint8 outcode) const;
+};
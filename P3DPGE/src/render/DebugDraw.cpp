@@ -0,0 +1,40 @@
+#include "DebugDraw.h"
+#include "../math/Math.h"
+#include "../utils/ThreadPool.h"
+
+void DebugDraw::Box(const Vector3& min, const Vector3& max, olc::Pixel color, const Matrix4& transform) {
+	//corner i takes max on the axes whose bit is set, so the edges join corners one bit apart
+	Vector3 corners[8];
+	for(int i = 0; i < 8; ++i) {
+		corners[i] = Vector3((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z) * transform;
+	}
+	for(int i = 0; i < 8; ++i) {
+		for(int bit = 1; bit < 8; bit <<= 1) {
+			if(!(i & bit)) { Line(corners[i], corners[i | bit], color); }
+		}
+	}
+}
+
+void DebugDraw::Sphere(const Vector3& center, float radius, olc::Pixel color, uint32 segments) {
+	if(segments < 3) { segments = 3; }
+	float step = 2.f * M_PI / segments;
+	for(uint32 i = 0; i < segments; ++i) {
+		float c0 = radius * cosf(step * i),		  s0 = radius * sinf(step * i);
+		float c1 = radius * cosf(step * (i + 1)), s1 = radius * sinf(step * (i + 1));
+		Line(center + Vector3(c0, s0, 0), center + Vector3(c1, s1, 0), color);
+		Line(center + Vector3(0, c0, s0), center + Vector3(0, c1, s1), color);
+		Line(center + Vector3(c0, 0, s0), center + Vector3(c1, 0, s1), color);
+	}
+}
+
+void DebugDraw::Transform(ThreadPool* pool, const Matrix4& view) {
+	viewPoints.resize(points.size());
+	uint32 batches = ((uint32)points.size() + BATCH_SIZE - 1) / BATCH_SIZE;
+	pool->ParallelFor(batches, [&](uint32 b) {
+		uint32 first = b * BATCH_SIZE;
+		uint32 last = std::min(first + BATCH_SIZE, (uint32)points.size());
+		for(uint32 i = first; i < last; ++i) {
+			viewPoints[i] = points[i] * view;
+		}
+	});
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "../math/Vector3.h"
+#include "../math/Matrix4.h"
+
+#include <vector>
+
+struct ThreadPool;
+
+//immediate mode debug lines, anything can add to it during a frame and the renderer draws everything
+//added since its last frame in one pass, then clears it
+//lines are kept as flat arrays whose memory is reused between frames, so adding one never allocates a line object
+struct DebugDraw {
+	static const uint32 BATCH_SIZE = 4096; //points per job when transforming
+
+	std::vector<Vector3> points;	 //world space, 2 per line
+	std::vector<uint32> colors;		 //olc::Pixel's packed rgba, 1 per line
+	std::vector<Vector3> viewPoints; //points through the view matrix, filled by Transform
+
+	void Line(const Vector3& start, const Vector3& end, olc::Pixel color = olc::WHITE) {
+		points.push_back(start);
+		points.push_back(end);
+		colors.push_back(color.n);
+	}
+
+	//the 12 edges of the box, its corners are taken through transform first
+	void Box(const Vector3& min, const Vector3& max, olc::Pixel color = olc::WHITE, const Matrix4& transform = Matrix4::IDENTITY);
+
+	//a circle around each axis
+	void Sphere(const Vector3& center, float radius, olc::Pixel color = olc::WHITE, uint32 segments = 16);
+
+	uint32 LineCount() const { return (uint32)colors.size(); }
+
+	void Clear() {
+		points.clear();
+		colors.clear();
+	}
+
+	//takes every point to view space, split into batches across the pool
+	void Transform(ThreadPool* pool, const Matrix4& view);
+};
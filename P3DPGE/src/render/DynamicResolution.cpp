@@ -0,0 +1,42 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr float DynamicResolution::STEP;
+
+void DynamicResolution::Reset() {
+	minScale = std::max(STEP, std::min(minScale, 1.f));
+	maxScale = std::max(minScale, std::min(maxScale, 1.f));
+	scale = maxScale;
+	averageMS = 0;
+	settle = 0;
+}
+
+bool DynamicResolution::Update(double rasterMS) {
+	//one slow frame shouldnt drop the resolution on its own
+	averageMS = (averageMS > 0) ? averageMS + .25f * ((float)rasterMS - averageMS) : (float)rasterMS;
+	if(settle > 0) {
+		settle--;
+		return false;
+	}
+	if(averageMS <= 0) { return false; }
+
+	//hold while between 80% and 100% of the target, otherwise aim for 90% of it
+	float ratio = averageMS / targetMS;
+	if(ratio > .8f && ratio <= 1.f) { return false; }
+	float wanted = scale * sqrtf(.9f / ratio);
+	wanted = std::max(scale * .75f, std::min(wanted, scale * 1.1f));
+	wanted = STEP * floorf(wanted / STEP + .5f);
+	wanted = std::max(minScale, std::min(wanted, maxScale));
+	if(wanted == scale) { return false; }
+
+	scale = wanted;
+	averageMS = 0;
+	settle = SETTLE_FRAMES;
+	return true;
+}
+
+int32 DynamicResolution::Scaled(float size) const {
+	return std::max(1, (int32)(size * scale + .5f));
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "../utils/UsefulDefines.h"
+
+//picks the fraction of the screen's resolution the scene is rasterized at so the raster stage holds a target time
+//the raster cost goes with the number of pixels, so the scale moves by the square root of how far off the target it is
+//it drops quickly when over budget and climbs back slowly, and waits a few frames after each change to measure the new one
+struct DynamicResolution {
+	static const uint32 SETTLE_FRAMES = 8; //frames the scale holds after it changes
+	static constexpr float STEP = 1.f / 32.f; //scales are kept to multiples of this so small swings dont resize the framebuffer
+
+	float targetMS = 8.f; //raster time budget
+	float minScale = .5f;
+	float maxScale = 1.f;
+	float scale = 1.f;
+
+	float averageMS = 0; //smoothed raster time at the current scale, 0 until its been measured
+	uint32 settle = 0;
+
+	//starts over at the largest scale, for when its turned on or its bounds change
+	void Reset();
+
+	//feeds the raster time of the last frame drawn at the current scale, returns true if the scale changed
+	bool Update(double rasterMS);
+
+	//size to render at for a screen of this size, at least 1 pixel
+	int32 Scaled(float size) const;
+};
@@ -0,0 +1,158 @@
+#include "Framebuffer.h"
+
+#include <cstring>
+#include <fstream>
+
+void Framebuffer::Resize(int32 width, int32 height) {
+	if(this->width == width && this->height == height) { return; }
+	this->width = width;
+	this->height = height;
+	color.resize((size_t)width * (size_t)height);
+	depth.resize((size_t)width * (size_t)height);
+}
+
+bool Framebuffer::Blit(olc::Sprite* target) const {
+	if(!target || target->width != width || target->height != height) { return false; }
+	static_assert(sizeof(olc::Pixel) == sizeof(uint32), "olc::Pixel must be a packed uint32 to copy the framebuffer into it");
+	std::memcpy(static_cast<void*>(target->GetData()), color.data(), color.size() * sizeof(uint32));
+	return true;
+}
+
+bool Framebuffer::BlitScaled(olc::Sprite* target) const {
+	if(!target || width <= 0 || height <= 0) { return false; }
+	if(target->width == width && target->height == height) { return Blit(target); }
+
+	//16.16 fixed point steps through the source, rows that sample the same source row are copied from the one above
+	uint32* out = (uint32*)target->GetData();
+	unsigned long long stepX = ((unsigned long long)width << 16) / target->width;
+	unsigned long long stepY = ((unsigned long long)height << 16) / target->height;
+	int32 lastRow = -1;
+	for(int32 y = 0; y < target->height; ++y) {
+		int32 row = (int32)((y * stepY) >> 16);
+		uint32* outRow = out + (size_t)y * target->width;
+		if(row == lastRow) {
+			std::memcpy(outRow, outRow - target->width, target->width * sizeof(uint32));
+			continue;
+		}
+		const uint32* source = color.data() + (size_t)row * width;
+		for(int32 x = 0; x < target->width; ++x) {
+			outRow[x] = source[(x * stepX) >> 16];
+		}
+		lastRow = row;
+	}
+	return true;
+}
+
+uint32 Framebuffer::Hash() const {
+	uint32 hash = 2166136261u;
+	for(uint32 pixel : color) {
+		for(int i = 0; i < 4; ++i) {
+			hash = (hash ^ ((pixel >> (8 * i)) & 0xFF)) * 16777619u;
+		}
+	}
+	return hash;
+}
+
+bool Framebuffer::SavePPM(const std::string& path) const {
+	std::ofstream file(path, std::ios::binary);
+	if(!file.is_open()) { return false; }
+
+	file << "P6\n" << width << " " << height << "\n255\n";
+	std::vector<uint8> row((size_t)width * 3);
+	for(int32 y = 0; y < height; ++y) {
+		for(int32 x = 0; x < width; ++x) {
+			olc::Pixel pixel(color[(size_t)y * width + x]);
+			row[3 * x + 0] = pixel.r;
+			row[3 * x + 1] = pixel.g;
+			row[3 * x + 2] = pixel.b;
+		}
+		file.write((const char*)row.data(), row.size());
+	}
+	return file.good();
+}
+
+//// PNG ////
+
+static uint32 PNGCrc(const uint8* data, size_t size, uint32 crc = 0xFFFFFFFFu) {
+	static uint32 table[256];
+	static bool tableBuilt = false;
+	if(!tableBuilt) {
+		for(uint32 n = 0; n < 256; ++n) {
+			uint32 c = n;
+			for(int k = 0; k < 8; ++k) { c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1; }
+			table[n] = c;
+		}
+		tableBuilt = true;
+	}
+	for(size_t i = 0; i < size; ++i) { crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8); }
+	return crc;
+}
+
+static void PNGPutU32(std::vector<uint8>& out, uint32 value) {
+	out.push_back(value >> 24); out.push_back(value >> 16); out.push_back(value >> 8); out.push_back(value);
+}
+
+//length, type, data, then a crc over the type and data
+static void PNGWriteChunk(std::ofstream& file, const char* type, const std::vector<uint8>& data) {
+	std::vector<uint8> chunk;
+	PNGPutU32(chunk, (uint32)data.size());
+	chunk.insert(chunk.end(), type, type + 4);
+	chunk.insert(chunk.end(), data.begin(), data.end());
+	std::vector<uint8> crc;
+	PNGPutU32(crc, PNGCrc(chunk.data() + 4, chunk.size() - 4) ^ 0xFFFFFFFFu);
+	chunk.insert(chunk.end(), crc.begin(), crc.end());
+	file.write((const char*)chunk.data(), chunk.size());
+}
+
+bool Framebuffer::SavePNG(const std::string& path) const {
+	std::ofstream file(path, std::ios::binary);
+	if(!file.is_open()) { return false; }
+
+	//8 bit rgb rows, each starting with filter type 0 (none)
+	std::vector<uint8> raw;
+	raw.reserve((size_t)height * (1 + (size_t)width * 3));
+	for(int32 y = 0; y < height; ++y) {
+		raw.push_back(0);
+		for(int32 x = 0; x < width; ++x) {
+			olc::Pixel pixel(color[(size_t)y * width + x]);
+			raw.push_back(pixel.r);
+			raw.push_back(pixel.g);
+			raw.push_back(pixel.b);
+		}
+	}
+
+	//zlib stream of stored deflate blocks (at most 65535 bytes each) followed by the adler32 of the raw data
+	std::vector<uint8> zlib = { 0x78, 0x01 };
+	size_t offset = 0;
+	do {
+		size_t size = std::min(raw.size() - offset, (size_t)65535);
+		bool last = offset + size == raw.size();
+		zlib.push_back(last ? 1 : 0);
+		zlib.push_back(size & 0xFF); zlib.push_back(size >> 8);
+		zlib.push_back(~size & 0xFF); zlib.push_back((~size >> 8) & 0xFF);
+		zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + size);
+		offset += size;
+	} while(offset < raw.size());
+	uint32 a = 1, b = 0;
+	for(uint8 byte : raw) {
+		a = (a + byte) % 65521;
+		b = (b + a) % 65521;
+	}
+	PNGPutU32(zlib, (b << 16) | a);
+
+	std::vector<uint8> header;
+	PNGPutU32(header, width);
+	PNGPutU32(header, height);
+	header.push_back(8);	//bit depth
+	header.push_back(2);	//color type rgb
+	header.push_back(0);	//compression
+	header.push_back(0);	//filter
+	header.push_back(0);	//no interlace
+
+	const uint8 signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	file.write((const char*)signature, 8);
+	PNGWriteChunk(file, "IHDR", header);
+	PNGWriteChunk(file, "IDAT", zlib);
+	PNGWriteChunk(file, "IEND", std::vector<uint8>());
+	return file.good();
+}
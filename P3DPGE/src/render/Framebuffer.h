@@ -0,0 +1,34 @@
+#pragma once
+#include "../math/Vector3.h"
+
+#include <string>
+#include <vector>
+
+//color and depth the scene renders into, packed row by row with no padding
+//the rasterizer writes texels straight into it instead of going through PixelGameEngine::Draw
+//per pixel, and it doesnt need a PixelGameEngine at all so it can be rendered to from any thread or without a window
+struct Framebuffer {
+	int32 width = 0;
+	int32 height = 0;
+	std::vector<uint32> color;	//olc::Pixel's packed rgba
+	std::vector<float> depth;	//1/w, larger is closer, 0 is nothing drawn
+
+	//only reallocates when the size changes, the contents are undefined after a resize until the next clear
+	void Resize(int32 width, int32 height);
+
+	//copies color into the sprite in one go, the sprite must be the same size
+	//returns false and leaves the sprite alone when it isnt
+	bool Blit(olc::Sprite* target) const;
+
+	//stretches color over the whole sprite with nearest neighbour sampling, for frames rendered below the screen's resolution
+	//returns false when theres nothing to copy
+	bool BlitScaled(olc::Sprite* target) const;
+
+	//fnv-1a over the color buffer, two renders of the same frame hash the same so it can stand in for a golden image
+	uint32 Hash() const;
+
+	//write the color buffer as an image, alpha is dropped, returns false if the file couldnt be written
+	//the png is uncompressed (stored deflate blocks) so it needs no zlib
+	bool SavePPM(const std::string& path) const;
+	bool SavePNG(const std::string& path) const;
+};
@@ -0,0 +1,153 @@
+#include "OcclusionBuffer.h"
+#include "Rasterizer.h"
+#include "Clipper.h"
+#include "VertexStage.h"
+#include "../math/Math.h"
+
+#include "../components/Mesh.h"
+#include "../components/Camera.h"
+#include "../components/Screen.h"
+
+void OcclusionBuffer::Render(const std::vector<MeshInstance>& meshes, Camera* camera, Screen* screen) {
+	width = std::max(1, ((int32)screen->width + DOWNSCALE - 1) / DOWNSCALE);
+	height = std::max(1, ((int32)screen->height + DOWNSCALE - 1) / DOWNSCALE);
+
+	//one level per halving down to a single texel, sized only when the screen changes
+	int32 levelCount = 1;
+	for(int32 w = width, h = height; w > 1 || h > 1; w = (w + 1) / 2, h = (h + 1) / 2) { levelCount++; }
+	levels.resize(levelCount);
+	for(int32 level = 0, w = width, h = height; level < levelCount; ++level, w = (w + 1) / 2, h = (h + 1) / 2) {
+		levels[level].resize((size_t)w * h);
+	}
+	int32 cornersW = width + 1;
+	int32 cornersH = height + 1;
+	corners.resize((size_t)cornersW * cornersH);
+	std::fill(corners.begin(), corners.end(), 0.f);
+
+//// Occluders ////
+
+	active = false;
+	occludedMeshes = 0;
+	occludedTriangles = 0;
+	GuardBand guard(width, height);
+	Vector2 dimensions(width, height);
+	Vector3 half(.5f, .5f, 0);
+	for(const MeshInstance& instance : meshes) {
+		if(!instance.occluder) { continue; }
+		active = true;
+
+		const Mesh* mesh = instance.mesh;
+		Matrix4 modelView = instance.model * camera->viewMatrix;
+		Vector3 eye = VertexStage::LocalEye(modelView);
+		for(size_t i = 0; i + 2 < mesh->indices.size(); i += 3) {
+			//same back-face test as the main pass, only the near side of an occluder can hide anything
+			const FacePlane& plane = mesh->facePlanes[i / 3];
+			if(plane.normal.dot(eye) <= plane.offset) { continue; }
+
+			Vector3 c[3];
+			for(int k = 0; k < 3; ++k) { c[k] = mesh->vertices[mesh->indices[i + k]] * modelView; }
+
+			ClipPolygon polygon;
+			ClipPolygon scratch;
+			polygon.count = 3;
+			for(int k = 0; k < 3; ++k) { polygon.vertices[k].position = c[k]; }
+			ClipPolygonToPlane(polygon, scratch, Vector3(0, 0, camera->nearZ), Vector3::FORWARD);
+			if(scratch.count < 3) { continue; }
+
+			uint8 outsideGuard = 0;
+			for(int k = 0; k < scratch.count; ++k) {
+				ClipVertex& v = scratch.vertices[k];
+				float w;
+				v.position = Math::CameraToScreen(v.position, camera->projectionMatrix, dimensions, w);
+				v.tex = Vector3(0, 0, 1.f / w);
+				outsideGuard |= GuardBand::Outcode(v.position, guard.minX, guard.minY, guard.maxX, guard.maxY);
+			}
+			ClipPolygon* clipped = outsideGuard ? guard.Clip(&scratch, &polygon, outsideGuard) : &scratch;
+
+			for(int k = 1; k + 1 < clipped->count; ++k) {
+				//pixels are sampled at their centers, shifting by half a texel samples the corners instead
+				RasterTriangle rt;
+				rt.points[0] = clipped->vertices[0].position + half;		rt.texPoints[0] = clipped->vertices[0].tex;
+				rt.points[1] = clipped->vertices[k].position + half;		rt.texPoints[1] = clipped->vertices[k].tex;
+				rt.points[2] = clipped->vertices[k + 1].position + half;	rt.texPoints[2] = clipped->vertices[k + 1].tex;
+				RasterizeDepth(rt, 0, 0, cornersW, cornersH, corners.data(), cornersW);
+			}
+		}
+	}
+	if(!active) { return; }
+
+//// Pyramid ////
+
+	//a texel is as near as its farthest corner, and uncovered (0) if any corner is
+	std::vector<float>& base = levels[0];
+	for(int32 y = 0; y < height; ++y) {
+		const float* top = corners.data() + (size_t)y * cornersW;
+		const float* bottom = top + cornersW;
+		for(int32 x = 0; x < width; ++x) {
+			base[(size_t)y * width + x] = std::min(std::min(top[x], top[x + 1]), std::min(bottom[x], bottom[x + 1]));
+		}
+	}
+
+	for(int32 level = 1, w = width, h = height; level < levelCount; ++level) {
+		const std::vector<float>& prev = levels[level - 1];
+		std::vector<float>& next = levels[level];
+		int32 nextW = (w + 1) / 2;
+		int32 nextH = (h + 1) / 2;
+		for(int32 y = 0; y < nextH; ++y) {
+			for(int32 x = 0; x < nextW; ++x) {
+				//odd sized levels have edge texels with only one or two children
+				int32 x0 = 2 * x, x1 = std::min(2 * x + 1, w - 1);
+				int32 y0 = 2 * y, y1 = std::min(2 * y + 1, h - 1);
+				next[(size_t)y * nextW + x] = std::min(std::min(prev[(size_t)y0 * w + x0], prev[(size_t)y0 * w + x1]),
+													   std::min(prev[(size_t)y1 * w + x0], prev[(size_t)y1 * w + x1]));
+			}
+		}
+		w = nextW;
+		h = nextH;
+	}
+}
+
+bool OcclusionBuffer::Occluded(Mesh* mesh, const Matrix4& modelView, Camera* camera) const {
+	if(!active) { return false; }
+
+	//project the box's corners, 1/w is linear in screen space so the box's nearest point is one of them
+	float minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY;
+	float nearest = 0;
+	for(int i = 0; i < 8; ++i) {
+		Vector3 corner((i & 1) ? mesh->boundsMax.x : mesh->boundsMin.x,
+					   (i & 2) ? mesh->boundsMax.y : mesh->boundsMin.y,
+					   (i & 4) ? mesh->boundsMax.z : mesh->boundsMin.z);
+		Vector3 c = corner * modelView;
+		if(c.z < camera->nearZ) { return false; } //the box reaches past the camera, it can't be behind anything
+
+		Vector4 clip = Vector4(c.x, c.y, c.z, 1.f) * camera->projectionMatrix;
+		float invW = 1.f / clip.w;
+		float x = (clip.x * invW + 1.f) * .5f * width;
+		float y = (clip.y * invW + 1.f) * .5f * height;
+		minX = std::min(minX, x); maxX = std::max(maxX, x);
+		minY = std::min(minY, y); maxY = std::max(maxY, y);
+		nearest = std::max(nearest, invW);
+	}
+
+	int32 x0 = std::max(0, (int32)floorf(minX));
+	int32 y0 = std::max(0, (int32)floorf(minY));
+	int32 x1 = std::min(width - 1, (int32)floorf(maxX));
+	int32 y1 = std::min(height - 1, (int32)floorf(maxY));
+	if(x0 > x1 || y0 > y1) { return false; } //off the buffer, frustum culling handles it
+
+	//go up the pyramid until the rect is at most 2 texels across
+	int32 level = 0;
+	int32 levelW = width;
+	while(level + 1 < (int32)levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)) {
+		level++;
+		levelW = (levelW + 1) / 2;
+	}
+
+	const std::vector<float>& depth = levels[level];
+	for(int32 y = y0 >> level; y <= (y1 >> level); ++y) {
+		for(int32 x = x0 >> level; x <= (x1 >> level); ++x) {
+			if(nearest >= depth[(size_t)y * levelW + x]) { return false; }
+		}
+	}
+	return true;
+}
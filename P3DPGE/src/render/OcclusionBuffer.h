@@ -0,0 +1,42 @@
+#pragma once
+#include "../math/Vector3.h"
+#include "../math/Matrix4.h"
+
+#include <vector>
+
+struct Mesh;
+struct MeshInstance;
+struct Camera;
+struct Screen;
+
+//a low resolution depth buffer that only meshes marked as occluders are drawn into, used to skip
+//meshes hidden behind them before their triangles are clipped and rasterized
+//depth is 1/w like the main depth buffer, so larger is closer and 0 is nothing drawn
+struct OcclusionBuffer {
+	static const int32 DOWNSCALE = 4; //screen pixels per occlusion pixel along each axis
+
+	int32 width = 0;
+	int32 height = 0;
+	bool active = false; //false when there were no occluders this frame, Occluded always fails then
+
+	//filled in by the renderer for the stats
+	int32 occludedMeshes = 0;
+	int32 occludedTriangles = 0;
+
+	//occluders are rasterized at the corners of the level 0 texels, (width + 1) x (height + 1) samples
+	//a texel only gets a depth when all 4 of its corners are covered, so at this resolution an occluder
+	//can never claim a texel it only partly covers
+	std::vector<float> corners;
+
+	//levels[0] is the nearest depth the occluders are known to cover each texel with, each level after it is half the size and holds the farthest
+	//(smallest) depth of the 2x2 texels under it, so a single texel bounds a whole region of the screen
+	std::vector<std::vector<float>> levels;
+
+	//resizes to the screen, then rasterizes every mesh with occluder set and builds the pyramid
+	void Render(const std::vector<MeshInstance>& meshes, Camera* camera, Screen* screen);
+
+	//true if the mesh's bounding box is entirely behind the occluders, tested at whichever level
+	//covers the box's screen rect with at most 2x2 texels
+	//modelView takes the mesh's local space to view space
+	bool Occluded(Mesh* mesh, const Matrix4& modelView, Camera* camera) const;
+};
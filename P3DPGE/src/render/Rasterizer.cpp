@@ -0,0 +1,198 @@
+#include "Rasterizer.h"
+#include "../utils/ThreadPool.h"
+
+#include <chrono>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+//// Kernels ////
+
+//the baseline build of the kernels, SSE2 on x86
+#define RASTER_NAMESPACE RasterBaseline
+#include "RasterizerKernels.h"
+#undef RASTER_NAMESPACE
+
+//the AVX2 build from RasterizerAVX2.cpp
+namespace RasterAVX2 {
+	extern const bool built; //false when the compiler couldnt target AVX2, its kernels are the baseline ones then
+	uint32 RasterizeTriangle(const RasterTriangle& tri, int32 minX, int32 minY, int32 maxX, int32 maxY,
+							 uint32* colorBuffer, float* depthBuffer, int32 stride);
+	uint32 RasterizeDepth(const RasterTriangle& tri, int32 minX, int32 minY, int32 maxX, int32 maxY,
+						  float* depthBuffer, int32 stride);
+	uint32 RasterizeId(const RasterTriangle& tri, uint32 id, int32 minX, int32 minY, int32 maxX, int32 maxY,
+					   uint32* idBuffer, float* depthBuffer, int32 stride);
+	uint32 ResolveTile(const std::vector<RasterTriangle>& triangles, const uint32* idBuffer, uint32* colorBuffer,
+					   int32 minX, int32 minY, int32 maxX, int32 maxY, int32 stride);
+}
+
+//true when the cpu and os support AVX2, the project itself is built for the default instruction set so it runs anywhere
+static bool CPUSupportsAVX2() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	int info[4];
+	__cpuid(info, 0);
+	if(info[0] < 7) { return false; }
+	//the os has to save the ymm registers too, which xgetbv reports once osxsave is set
+	__cpuid(info, 1);
+	bool avx = (info[2] & (1 << 28)) != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	if(!avx || !osxsave || (_xgetbv(0) & 6) != 6) { return false; }
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+//checked once, both builds produce exactly the same pixels
+static bool UseAVX2() {
+	static const bool use = RasterAVX2::built && CPUSupportsAVX2();
+	return use;
+}
+
+uint32 RasterizeTriangle(const RasterTriangle& tri, int32 minX, int32 minY, int32 maxX, int32 maxY,
+						 uint32* colorBuffer, float* depthBuffer, int32 stride) {
+	return UseAVX2() ? RasterAVX2::RasterizeTriangle(tri, minX, minY, maxX, maxY, colorBuffer, depthBuffer, stride)
+					 : RasterBaseline::RasterizeTriangle(tri, minX, minY, maxX, maxY, colorBuffer, depthBuffer, stride);
+}
+
+uint32 RasterizeDepth(const RasterTriangle& tri, int32 minX, int32 minY, int32 maxX, int32 maxY,
+					  float* depthBuffer, int32 stride) {
+	return UseAVX2() ? RasterAVX2::RasterizeDepth(tri, minX, minY, maxX, maxY, depthBuffer, stride)
+					 : RasterBaseline::RasterizeDepth(tri, minX, minY, maxX, maxY, depthBuffer, stride);
+}
+
+uint32 RasterizeId(const RasterTriangle& tri, uint32 id, int32 minX, int32 minY, int32 maxX, int32 maxY,
+				   uint32* idBuffer, float* depthBuffer, int32 stride) {
+	return UseAVX2() ? RasterAVX2::RasterizeId(tri, id, minX, minY, maxX, maxY, idBuffer, depthBuffer, stride)
+					 : RasterBaseline::RasterizeId(tri, id, minX, minY, maxX, maxY, idBuffer, depthBuffer, stride);
+}
+
+static uint32 ResolveTile(const std::vector<RasterTriangle>& triangles, const uint32* idBuffer, uint32* colorBuffer,
+						  int32 minX, int32 minY, int32 maxX, int32 maxY, int32 stride) {
+	return UseAVX2() ? RasterAVX2::ResolveTile(triangles, idBuffer, colorBuffer, minX, minY, maxX, maxY, stride)
+					 : RasterBaseline::ResolveTile(triangles, idBuffer, colorBuffer, minX, minY, maxX, maxY, stride);
+}
+
+//// Rasterizer ////
+
+void Rasterizer::Begin(int32 width, int32 height) {
+	this->width = width;
+	this->height = height;
+	tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+	bins.resize((size_t)tilesX * tilesY);
+	for(auto& bin : bins) { bin.clear(); }
+	tileDepths.resize(bins.size());
+	hizRejectedPixels = 0;
+	triangles.clear();
+}
+
+void Rasterizer::Bin() {
+	for(uint32 i = 0; i < triangles.size(); ++i) {
+		const RasterTriangle& tri = triangles[i];
+		//pixels are sampled at their centers, so flooring the bounds never misses a covered pixel
+		int32 minX = (int32)floorf(std::min(tri.points[0].x, std::min(tri.points[1].x, tri.points[2].x)));
+		int32 maxX = (int32)floorf(std::max(tri.points[0].x, std::max(tri.points[1].x, tri.points[2].x)));
+		int32 minY = (int32)floorf(std::min(tri.points[0].y, std::min(tri.points[1].y, tri.points[2].y)));
+		int32 maxY = (int32)floorf(std::max(tri.points[0].y, std::max(tri.points[1].y, tri.points[2].y)));
+		if(maxX < 0 || maxY < 0 || minX >= width || minY >= height) { continue; }
+
+		int32 tileMinX = std::max(minX, 0) / TILE_SIZE;
+		int32 tileMaxX = std::min(maxX, width - 1) / TILE_SIZE;
+		int32 tileMinY = std::max(minY, 0) / TILE_SIZE;
+		int32 tileMaxY = std::min(maxY, height - 1) / TILE_SIZE;
+		for(int32 ty = tileMinY; ty <= tileMaxY; ++ty) {
+			for(int32 tx = tileMinX; tx <= tileMaxX; ++tx) {
+				bins[(size_t)ty * tilesX + tx].push_back(i);
+			}
+		}
+	}
+}
+
+//conservative pixel bounds of the triangle inside the rect, same flooring as Bin
+static uint32 BoundsArea(const RasterTriangle& tri, int32 minX, int32 minY, int32 maxX, int32 maxY) {
+	int32 x0 = std::max(minX, (int32)floorf(std::min(tri.points[0].x, std::min(tri.points[1].x, tri.points[2].x))));
+	int32 x1 = std::min(maxX, (int32)floorf(std::max(tri.points[0].x, std::max(tri.points[1].x, tri.points[2].x))) + 1);
+	int32 y0 = std::max(minY, (int32)floorf(std::min(tri.points[0].y, std::min(tri.points[1].y, tri.points[2].y))));
+	int32 y1 = std::min(maxY, (int32)floorf(std::max(tri.points[0].y, std::max(tri.points[1].y, tri.points[2].y))) + 1);
+	return (x1 > x0 && y1 > y0) ? (uint32)((x1 - x0) * (y1 - y0)) : 0;
+}
+
+void Rasterizer::Draw(ThreadPool* pool, Framebuffer* framebuffer, uint32 clearColor) {
+	uint32* colorBuffer = framebuffer->color.data();
+	float* depthBuffer = framebuffer->depth.data();
+	if(visibilityBuffer) { ids.resize((size_t)width * height); }
+	uint32* idBuffer = ids.data();
+	pool->ParallelFor(bins.size(), [&](uint32 tile) {
+		int32 minX = (tile % tilesX) * TILE_SIZE;
+		int32 minY = (tile / tilesX) * TILE_SIZE;
+		int32 maxX = std::min(minX + TILE_SIZE, width);
+		int32 maxY = std::min(minY + TILE_SIZE, height);
+
+		//clear, 0 is infinitely far away
+		for(int32 y = minY; y < maxY; ++y) {
+			std::fill(colorBuffer + (size_t)y * width + minX, colorBuffer + (size_t)y * width + maxX, clearColor);
+			std::fill(depthBuffer + (size_t)y * width + minX, depthBuffer + (size_t)y * width + maxX, 0.f);
+			if(visibilityBuffer) {
+				std::fill(idBuffer + (size_t)y * width + minX, idBuffer + (size_t)y * width + maxX, 0);
+			}
+		}
+		TileDepth& hiz = tileDepths[tile];
+		hiz = TileDepth();
+
+		for(uint32 i : bins[tile]) {
+			const RasterTriangle& tri = triangles[i];
+
+			//1/w is linear in screen space so the nearest point of the triangle is one of its vertices
+			float nearest = std::max(tri.texPoints[0].z, std::max(tri.texPoints[1].z, tri.texPoints[2].z));
+			if(nearest < hiz.farthest) {
+				hiz.rejectedPixels += BoundsArea(tri, minX, minY, maxX, maxY);
+				continue;
+			}
+
+			uint32 written = visibilityBuffer ? RasterizeId(tri, i + 1, minX, minY, maxX, maxY, idBuffer, depthBuffer, width)
+											  : RasterizeTriangle(tri, minX, minY, maxX, maxY, colorBuffer, depthBuffer, width);
+			hiz.writtenPixels += written;
+			hiz.writtenSinceRefresh += written;
+			if(hiz.writtenSinceRefresh >= HIZ_REFRESH_PIXELS) {
+				float farthest = INFINITY;
+				for(int32 y = minY; y < maxY; ++y) {
+					const float* row = depthBuffer + (size_t)y * width;
+					for(int32 x = minX; x < maxX; ++x) { farthest = std::min(farthest, row[x]); }
+				}
+				hiz.farthest = farthest;
+				hiz.writtenSinceRefresh = 0;
+			}
+		}
+
+		if(visibilityBuffer) {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			hiz.shadedPixels = ResolveTile(triangles, idBuffer, colorBuffer, minX, minY, maxX, maxY, width);
+			hiz.coveredPixels = hiz.shadedPixels;
+			hiz.shadeMS = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		} else {
+			//every depth test pass was shaded
+			hiz.shadedPixels = hiz.writtenPixels;
+			for(int32 y = minY; y < maxY; ++y) {
+				const float* row = depthBuffer + (size_t)y * width;
+				for(int32 x = minX; x < maxX; ++x) { hiz.coveredPixels += (row[x] > 0) ? 1 : 0; }
+			}
+		}
+	});
+
+	hizRejectedPixels = 0;
+	writtenPixels = 0;
+	shadedPixels = 0;
+	coveredPixels = 0;
+	shadeMS = 0;
+	for(TileDepth& hiz : tileDepths) {
+		hizRejectedPixels += hiz.rejectedPixels;
+		writtenPixels += hiz.writtenPixels;
+		shadedPixels += hiz.shadedPixels;
+		coveredPixels += hiz.coveredPixels;
+		shadeMS += hiz.shadeMS;
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "../math/Vector3.h"
+#include "Texture.h"
+#include "Framebuffer.h"
+#include "ShadowMap.h"
+
+#include <vector>
+
+struct ThreadPool;
+
+//a clipped triangle ready to be filled, everything the fill needs is resolved when its submitted
+//so the worker threads never have to touch entities or components
+struct RasterTriangle {
+	Vector3 points[3];		//screen space, z is unused
+	Vector3 texPoints[3];	//u/w, v/w, 1/w so they can be interpolated linearly in screen space
+	const Texture* texture = nullptr;
+	olc::Pixel color = olc::WHITE; //used when there is no texture
+	const ShadowMap* shadow = nullptr; //pixels behind a caster in it are darkened
+	Vector3 shadowPoints[3];	//the points through the shadow map's lightMatrix over w, only set with a shadow map
+};
+
+//fills the part of the triangle inside the [minX, maxX) x [minY, maxY) rect into the color and depth buffers, depth is 1/w so larger is closer
+//returns the number of pixels that passed the depth test
+//pixels are sampled at their centers with the top-left fill rule, so triangles sharing an edge never overlap or leave gaps
+//minX must be a multiple of 8 (tiles always are) so SIMD blocks dont straddle rects
+uint32 RasterizeTriangle(const RasterTriangle& tri, int32 minX, int32 minY, int32 maxX, int32 maxY,
+						 uint32* colorBuffer, float* depthBuffer, int32 stride);
+
+//same as RasterizeTriangle but only writes depth, used for light depth textures
+uint32 RasterizeDepth(const RasterTriangle& tri, int32 minX, int32 minY, int32 maxX, int32 maxY,
+					  float* depthBuffer, int32 stride);
+
+//same as RasterizeTriangle but writes id instead of shading the pixel, used for the visibility buffer
+uint32 RasterizeId(const RasterTriangle& tri, uint32 id, int32 minX, int32 minY, int32 maxX, int32 maxY,
+				   uint32* idBuffer, float* depthBuffer, int32 stride);
+
+//sorts screen space triangles into tiles, then fills the tiles in parallel
+//each tile is only ever touched by one thread so its color and depth writes need no locks, and
+//triangles are kept in submission order within a tile so depth ties resolve the same as drawing serially
+struct Rasterizer {
+	static const int32 TILE_SIZE = 64;
+	static const int32 SUBPIXEL_STEPS = 16;	//vertices snap to 1/16th of a pixel
+	//edge functions are 32 bit, which holds triangles up to this many pixels across at 16 subpixel steps
+	//triangles larger than this or with points past MAX_COORD are skipped, clipping keeps them in range
+	static const int32 MAX_EXTENT = 2000;
+	static const int32 MAX_COORD = 16384;
+
+	//a tile's farthest depth is refreshed once this many of its pixels have been written since the last refresh
+	static const uint32 HIZ_REFRESH_PIXELS = TILE_SIZE * TILE_SIZE / 4;
+
+	//hierarchical z for a tile, depth is 1/w so the farthest pixel in the tile is its minimum
+	//a triangle whose nearest vertex is behind that can't pass a single depth test in the tile
+	//also counts the tile's pixels for the stats
+	struct TileDepth {
+		float farthest = 0;
+		uint32 writtenSinceRefresh = 0;
+		uint32 rejectedPixels = 0;
+		uint32 writtenPixels = 0;	//depth test passes
+		uint32 shadedPixels = 0;	//texture and shadow lookups
+		uint32 coveredPixels = 0;	//pixels something was drawn to
+		double shadeMS = 0;			//resolving the visibility buffer
+	};
+
+	int32 width = 0;
+	int32 height = 0;
+	int32 tilesX = 0;
+	int32 tilesY = 0;
+	std::vector<RasterTriangle> triangles;
+	std::vector<std::vector<uint32>> bins; //triangle indices per tile, row major
+	std::vector<TileDepth> tileDepths;
+	uint32 hizRejectedPixels = 0; //pixels skipped by hi-z in the last Draw, counted over each rejected triangle's bounds in the tile
+
+	//rasterize only depth and the index of the triangle that won each pixel, then shade every covered pixel once
+	//instead of shading each time one passes the depth test, so overdraw only costs the depth test
+	bool visibilityBuffer = false;
+	std::vector<uint32> ids; //the visibility buffer, triangle index + 1 per pixel and 0 where nothing was drawn
+
+	//pixel counts of the last Draw, writtenPixels over coveredPixels is how many times each pixel was drawn to
+	uint32 writtenPixels = 0;
+	uint32 shadedPixels = 0;
+	uint32 coveredPixels = 0;
+	double shadeMS = 0; //milliseconds the last Draw spent resolving the visibility buffer, summed across the tiles
+	float Overdraw() const { return coveredPixels ? (float)writtenPixels / coveredPixels : 0.f; }
+
+	//clears last frame's triangles and bins (keeping their memory) and sizes the tile grid to the target
+	void Begin(int32 width, int32 height);
+
+	//adds each triangle's index to every tile its screen bounds overlap
+	void Bin();
+
+	//clears the framebuffer and fills every tile, split across the pool's threads
+	//each tile clears its own part of the framebuffer so the clear is parallel and leaves it in cache for the fill
+	//with visibilityBuffer on each tile is resolved right after its ids are drawn, while theyre still in cache
+	//the framebuffer must be the size passed to Begin
+	void Draw(ThreadPool* pool, Framebuffer* framebuffer, uint32 clearColor);
+};
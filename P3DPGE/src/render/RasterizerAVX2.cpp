@@ -0,0 +1,12 @@
+//the rasterizer's kernels built for AVX2, this file alone is compiled with /arch:AVX2 (-mavx2)
+//Rasterizer.cpp only calls into it when the cpu supports AVX2
+#define RASTER_NAMESPACE RasterAVX2
+#include "RasterizerKernels.h"
+
+namespace RasterAVX2 {
+#if defined(__AVX2__)
+	extern const bool built = true;
+#else
+	extern const bool built = false;
+#endif
+}
@@ -0,0 +1,428 @@
+//the fill kernels, included once per instruction set by Rasterizer.cpp and RasterizerAVX2.cpp
+//each includer defines RASTER_NAMESPACE first so the two builds dont collide, Rasterizer.cpp picks one at runtime
+#include "Rasterizer.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+
+namespace RASTER_NAMESPACE {
+
+//// SIMD lanes ////
+
+//the edge tests run on a block of pixels in a row at once, AVX2 when the file including this is built for it,
+//SSE2 on any other x86 build, and a plain array otherwise so other targets still compile
+#if defined(__AVX2__)
+#define RASTER_LANES 8
+typedef __m256i VInt;
+typedef __m256  VFloat;
+inline VInt   VSetInt(int32 a)						{ return _mm256_set1_epi32(a); }
+inline VInt   VLoadInt(const int32* a)				{ return _mm256_loadu_si256((const __m256i*)a); }
+inline VInt   VAddInt(VInt a, VInt b)				{ return _mm256_add_epi32(a, b); }
+inline VInt   VOrInt(VInt a, VInt b)				{ return _mm256_or_si256(a, b); }
+inline VFloat VNonNegative(VInt a)					{ return _mm256_castsi256_ps(_mm256_cmpgt_epi32(a, _mm256_set1_epi32(-1))); }
+inline VFloat VToFloat(VInt a)						{ return _mm256_cvtepi32_ps(a); }
+inline VFloat VSet(float a)							{ return _mm256_set1_ps(a); }
+inline VFloat VLoad(const float* a)					{ return _mm256_loadu_ps(a); }
+inline void   VStore(float* a, VFloat b)			{ _mm256_storeu_ps(a, b); }
+inline VFloat VAdd(VFloat a, VFloat b)				{ return _mm256_add_ps(a, b); }
+inline VFloat VMul(VFloat a, VFloat b)				{ return _mm256_mul_ps(a, b); }
+inline VFloat VDiv(VFloat a, VFloat b)				{ return _mm256_div_ps(a, b); }
+inline VFloat VGreater(VFloat a, VFloat b)			{ return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline VFloat VAnd(VFloat a, VFloat b)				{ return _mm256_and_ps(a, b); }
+inline VFloat VSelect(VFloat mask, VFloat a, VFloat b) { return _mm256_blendv_ps(b, a, mask); }
+inline int32  VBits(VFloat mask)					{ return _mm256_movemask_ps(mask); }
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RASTER_LANES 4
+typedef __m128i VInt;
+typedef __m128  VFloat;
+inline VInt   VSetInt(int32 a)						{ return _mm_set1_epi32(a); }
+inline VInt   VLoadInt(const int32* a)				{ return _mm_loadu_si128((const __m128i*)a); }
+inline VInt   VAddInt(VInt a, VInt b)				{ return _mm_add_epi32(a, b); }
+inline VInt   VOrInt(VInt a, VInt b)				{ return _mm_or_si128(a, b); }
+inline VFloat VNonNegative(VInt a)					{ return _mm_castsi128_ps(_mm_cmpgt_epi32(a, _mm_set1_epi32(-1))); }
+inline VFloat VToFloat(VInt a)						{ return _mm_cvtepi32_ps(a); }
+inline VFloat VSet(float a)							{ return _mm_set1_ps(a); }
+inline VFloat VLoad(const float* a)					{ return _mm_loadu_ps(a); }
+inline void   VStore(float* a, VFloat b)			{ _mm_storeu_ps(a, b); }
+inline VFloat VAdd(VFloat a, VFloat b)				{ return _mm_add_ps(a, b); }
+inline VFloat VMul(VFloat a, VFloat b)				{ return _mm_mul_ps(a, b); }
+inline VFloat VDiv(VFloat a, VFloat b)				{ return _mm_div_ps(a, b); }
+inline VFloat VGreater(VFloat a, VFloat b)			{ return _mm_cmpgt_ps(a, b); }
+inline VFloat VAnd(VFloat a, VFloat b)				{ return _mm_and_ps(a, b); }
+inline VFloat VSelect(VFloat mask, VFloat a, VFloat b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+inline int32  VBits(VFloat mask)					{ return _mm_movemask_ps(mask); }
+#else
+#define RASTER_LANES 4
+struct VInt   { int32 v[RASTER_LANES]; };
+struct VFloat { float v[RASTER_LANES]; }; //masks are 1 or 0 per lane
+#define VLANES(expr) for(int32 i = 0; i < RASTER_LANES; ++i) { expr; }
+inline VInt   VSetInt(int32 a)						{ VInt r; VLANES(r.v[i] = a); return r; }
+inline VInt   VLoadInt(const int32* a)				{ VInt r; VLANES(r.v[i] = a[i]); return r; }
+inline VInt   VAddInt(VInt a, VInt b)				{ VInt r; VLANES(r.v[i] = a.v[i] + b.v[i]); return r; }
+inline VInt   VOrInt(VInt a, VInt b)				{ VInt r; VLANES(r.v[i] = a.v[i] | b.v[i]); return r; }
+inline VFloat VNonNegative(VInt a)					{ VFloat r; VLANES(r.v[i] = (a.v[i] >= 0) ? 1.f : 0.f); return r; }
+inline VFloat VToFloat(VInt a)						{ VFloat r; VLANES(r.v[i] = (float)a.v[i]); return r; }
+inline VFloat VSet(float a)							{ VFloat r; VLANES(r.v[i] = a); return r; }
+inline VFloat VLoad(const float* a)					{ VFloat r; VLANES(r.v[i] = a[i]); return r; }
+inline void   VStore(float* a, VFloat b)			{ VLANES(a[i] = b.v[i]); }
+inline VFloat VAdd(VFloat a, VFloat b)				{ VFloat r; VLANES(r.v[i] = a.v[i] + b.v[i]); return r; }
+inline VFloat VMul(VFloat a, VFloat b)				{ VFloat r; VLANES(r.v[i] = a.v[i] * b.v[i]); return r; }
+inline VFloat VDiv(VFloat a, VFloat b)				{ VFloat r; VLANES(r.v[i] = a.v[i] / b.v[i]); return r; }
+inline VFloat VGreater(VFloat a, VFloat b)			{ VFloat r; VLANES(r.v[i] = (a.v[i] > b.v[i]) ? 1.f : 0.f); return r; }
+inline VFloat VAnd(VFloat a, VFloat b)				{ VFloat r; VLANES(r.v[i] = a.v[i] * b.v[i]); return r; }
+inline VFloat VSelect(VFloat mask, VFloat a, VFloat b) { VFloat r; VLANES(r.v[i] = mask.v[i] ? a.v[i] : b.v[i]); return r; }
+inline int32  VBits(VFloat mask)					{ int32 r = 0; VLANES(r |= (mask.v[i] ? 1 : 0) << i); return r; }
+#undef VLANES
+#endif
+
+//// Half-space Rasterization ////
+
+//the three edge functions of a triangle in 28.4 fixed point, evaluated at pixel centers
+//edge k is the one opposite vertex k, so its value over twice the area is vertex k's barycentric weight
+struct TriangleSetup {
+	int32 minX, minY, maxX, maxY;	//pixel bounds, inclusive
+	int32 stepX[3];					//change in each edge function per pixel in x
+	int32 stepY[3];					//and per pixel in y
+	long long X[3], Y[3];			//snapped vertices
+	int32 bias[3];					//top-left fill rule, 1 on edges that dont own their pixels
+	float invArea;
+	Vector3 attributes[3];			//u/w, v/w, 1/w in the (possibly swapped) vertex order
+	Vector3 shadowAttributes[3];	//shadow map position over w, same order
+};
+
+static int32 FloorDiv(long long a, long long b) {
+	return (int32)((a >= 0) ? a / b : -((-a + b - 1) / b));
+}
+
+//snaps the triangle to the fixed point grid and orients it so the inside of every edge is positive
+//returns false for degenerate triangles and ones too large for the 32 bit edge values
+static bool SetupTriangle(const RasterTriangle& tri, TriangleSetup& setup) {
+	for(int i = 0; i < 3; ++i) {
+		//also rejects NaN
+		if(!(fabs(tri.points[i].x) <= Rasterizer::MAX_COORD && fabs(tri.points[i].y) <= Rasterizer::MAX_COORD)) { return false; }
+		setup.X[i] = (long long)floorf(tri.points[i].x * Rasterizer::SUBPIXEL_STEPS + .5f);
+		setup.Y[i] = (long long)floorf(tri.points[i].y * Rasterizer::SUBPIXEL_STEPS + .5f);
+		setup.attributes[i] = tri.texPoints[i];
+		setup.shadowAttributes[i] = tri.shadowPoints[i];
+	}
+
+	long long area = (setup.X[1] - setup.X[0]) * (setup.Y[2] - setup.Y[0]) - (setup.Y[1] - setup.Y[0]) * (setup.X[2] - setup.X[0]);
+	if(area == 0) { return false; }
+	if(area < 0) {
+		std::swap(setup.X[1], setup.X[2]);
+		std::swap(setup.Y[1], setup.Y[2]);
+		std::swap(setup.attributes[1], setup.attributes[2]);
+		std::swap(setup.shadowAttributes[1], setup.shadowAttributes[2]);
+		area = -area;
+	}
+
+	long long minFX = std::min(setup.X[0], std::min(setup.X[1], setup.X[2]));
+	long long maxFX = std::max(setup.X[0], std::max(setup.X[1], setup.X[2]));
+	long long minFY = std::min(setup.Y[0], std::min(setup.Y[1], setup.Y[2]));
+	long long maxFY = std::max(setup.Y[0], std::max(setup.Y[1], setup.Y[2]));
+	if(maxFX - minFX > Rasterizer::MAX_EXTENT * Rasterizer::SUBPIXEL_STEPS ||
+	   maxFY - minFY > Rasterizer::MAX_EXTENT * Rasterizer::SUBPIXEL_STEPS) {
+		return false;
+	}
+
+	//pixels whose centers can be inside, centers sit at half a pixel
+	long long half = Rasterizer::SUBPIXEL_STEPS / 2;
+	setup.minX = FloorDiv(minFX - half, Rasterizer::SUBPIXEL_STEPS);
+	setup.minY = FloorDiv(minFY - half, Rasterizer::SUBPIXEL_STEPS);
+	setup.maxX = FloorDiv(maxFX - half, Rasterizer::SUBPIXEL_STEPS);
+	setup.maxY = FloorDiv(maxFY - half, Rasterizer::SUBPIXEL_STEPS);
+
+	for(int k = 0; k < 3; ++k) {
+		int a = (k + 1) % 3;
+		int b = (k + 2) % 3;
+		long long dx = setup.X[b] - setup.X[a];
+		long long dy = setup.Y[b] - setup.Y[a];
+		setup.stepX[k] = (int32)(-dy * Rasterizer::SUBPIXEL_STEPS);
+		setup.stepY[k] = (int32)( dx * Rasterizer::SUBPIXEL_STEPS);
+		//y points down, so a top edge runs right and a left edge runs up
+		bool topLeft = (dy == 0 && dx > 0) || dy < 0;
+		setup.bias[k] = topLeft ? 0 : 1;
+	}
+	setup.invArea = 1.f / (float)area;
+	return true;
+}
+
+//value of edge k at the center of pixel (x, y), minus its fill rule bias
+static int32 EdgeAt(const TriangleSetup& setup, int k, int32 x, int32 y) {
+	int a = (k + 1) % 3;
+	int b = (k + 2) % 3;
+	long long px = (long long)x * Rasterizer::SUBPIXEL_STEPS + Rasterizer::SUBPIXEL_STEPS / 2;
+	long long py = (long long)y * Rasterizer::SUBPIXEL_STEPS + Rasterizer::SUBPIXEL_STEPS / 2;
+	return (int32)((setup.X[b] - setup.X[a]) * (py - setup.Y[a]) - (setup.Y[b] - setup.Y[a]) * (px - setup.X[a])) - setup.bias[k];
+}
+
+//the per triangle constants a fill interpolates from, worked out once per triangle
+struct ShadeSetup {
+	//attribute = a0 + l1 * (a1 - a0) + l2 * (a2 - a0), all of them over w
+	VFloat u0, du1, du2;
+	VFloat v0, dv1, dv2;
+	VFloat sx0, dsx1, dsx2;
+	VFloat sy0, dsy1, dsy2;
+	VFloat sz0, dsz1, dsz2;
+	const Texture* texture;
+	int32 mip;
+	bool bilinear;
+	const ShadowMap* shadow;
+	uint32 color;
+
+	void Init(const RasterTriangle& tri, const TriangleSetup& setup) {
+		const Vector3* attr = setup.attributes;
+		u0 = VSet(attr[0].x); du1 = VSet(attr[1].x - attr[0].x); du2 = VSet(attr[2].x - attr[0].x);
+		v0 = VSet(attr[0].y); dv1 = VSet(attr[1].y - attr[0].y); dv2 = VSet(attr[2].y - attr[0].y);
+
+		//the texture, its level and filter are picked once for the whole triangle
+		texture = tri.texture;
+		mip = texture ? texture->SelectMip(tri.points, tri.texPoints) : 0;
+		bilinear = texture && texture->filter == Texture::FILTER_BILINEAR;
+		color = tri.color.n;
+
+		//the shadow map position is interpolated the same way as u and v
+		shadow = tri.shadow;
+		const Vector3* sattr = setup.shadowAttributes;
+		sx0 = VSet(sattr[0].x); dsx1 = VSet(sattr[1].x - sattr[0].x); dsx2 = VSet(sattr[2].x - sattr[0].x);
+		sy0 = VSet(sattr[0].y); dsy1 = VSet(sattr[1].y - sattr[0].y); dsy2 = VSet(sattr[2].y - sattr[0].y);
+		sz0 = VSet(sattr[0].z); dsz1 = VSet(sattr[1].z - sattr[0].z); dsz2 = VSet(sattr[2].z - sattr[0].z);
+	}
+};
+
+//writes the shaded color of the block's lanes in mask to colorRow, l1 and l2 are the barycentrics of vertices 1 and 2
+//and w is the interpolated 1/w
+static inline void ShadeBlock(const ShadeSetup& shade, VFloat l1, VFloat l2, VFloat w, int32 mask, uint32* colorRow) {
+	alignas(32) float us[RASTER_LANES];
+	alignas(32) float vs[RASTER_LANES];
+	if(shade.texture) {
+		//perspective correct u and v
+		VStore(us, VDiv(VAdd(shade.u0, VAdd(VMul(l1, shade.du1), VMul(l2, shade.du2))), w));
+		VStore(vs, VDiv(VAdd(shade.v0, VAdd(VMul(l1, shade.dv1), VMul(l2, shade.dv2))), w));
+		if(shade.bilinear) {
+			for(int32 i = 0; i < RASTER_LANES; ++i) {
+				if(mask & (1 << i)) { colorRow[i] = shade.texture->SampleBilinear(shade.mip, us[i], vs[i]); }
+			}
+		} else {
+			for(int32 i = 0; i < RASTER_LANES; ++i) {
+				if(mask & (1 << i)) { colorRow[i] = shade.texture->SampleNearest(shade.mip, us[i], vs[i]); }
+			}
+		}
+	} else {
+		for(int32 i = 0; i < RASTER_LANES; ++i) {
+			if(mask & (1 << i)) { colorRow[i] = shade.color; }
+		}
+	}
+
+	//halve the rgb of shadowed pixels, keeping alpha
+	if(shade.shadow) {
+		alignas(32) float szs[RASTER_LANES];
+		VStore(us, VDiv(VAdd(shade.sx0, VAdd(VMul(l1, shade.dsx1), VMul(l2, shade.dsx2))), w));
+		VStore(vs, VDiv(VAdd(shade.sy0, VAdd(VMul(l1, shade.dsy1), VMul(l2, shade.dsy2))), w));
+		VStore(szs, VDiv(VAdd(shade.sz0, VAdd(VMul(l1, shade.dsz1), VMul(l2, shade.dsz2))), w));
+		for(int32 i = 0; i < RASTER_LANES; ++i) {
+			if((mask & (1 << i)) && !shade.shadow->Lit(us[i], vs[i], szs[i])) {
+				uint32 c = colorRow[i];
+				colorRow[i] = ((c >> 1) & 0x007F7F7F) | (c & 0xFF000000);
+			}
+		}
+	}
+}
+
+//what ScanTriangle writes besides depth
+enum RasterOutput {
+	OUTPUT_DEPTH,	//nothing
+	OUTPUT_COLOR,	//the shaded color to colorBuffer
+	OUTPUT_ID		//the triangle's id to colorBuffer, shaded later by ResolveTile
+};
+
+//walks the triangle's bounds inside the rect a block of lanes at a time. the edge functions are
+//stepped incrementally as integers, so coverage is exact and the barycentrics never drift
+//rect minX must be a multiple of RASTER_LANES so blocks never straddle two tiles
+template<RasterOutput Output>
+static uint32 ScanTriangle(const RasterTriangle& tri, uint32 id, int32 minX, int32 minY, int32 maxX, int32 maxY,
+						 uint32* colorBuffer, float* depthBuffer, int32 stride) {
+	const bool WriteColor = Output == OUTPUT_COLOR;
+	TriangleSetup setup;
+	if(!SetupTriangle(tri, setup)) { return 0; }
+
+	int32 startY = std::max(setup.minY, minY);
+	int32 endY = std::min(setup.maxY + 1, maxY);
+	int32 startX = std::max(setup.minX, minX);
+	int32 endX = std::min(setup.maxX + 1, maxX);
+	if(startX >= endX || startY >= endY) { return 0; }
+	startX = minX + ((startX - minX) / RASTER_LANES) * RASTER_LANES;
+
+	alignas(32) int32 laneOffsets[3][RASTER_LANES];
+	int32 blockStep[3];
+	int32 rowStart[3];
+	for(int k = 0; k < 3; ++k) {
+		for(int32 i = 0; i < RASTER_LANES; ++i) { laneOffsets[k][i] = setup.stepX[k] * i; }
+		blockStep[k] = setup.stepX[k] * RASTER_LANES;
+		rowStart[k] = EdgeAt(setup, k, startX, startY);
+	}
+	VInt offset0 = VLoadInt(laneOffsets[0]);
+	VInt offset1 = VLoadInt(laneOffsets[1]);
+	VInt offset2 = VLoadInt(laneOffsets[2]);
+
+	//1/w = w0 + l1 * (w1 - w0) + l2 * (w2 - w0)
+	const Vector3* attr = setup.attributes;
+	VFloat invArea = VSet(setup.invArea);
+	VFloat w0 = VSet(attr[0].z), dw1 = VSet(attr[1].z - attr[0].z), dw2 = VSet(attr[2].z - attr[0].z);
+
+	ShadeSetup shade;
+	if(WriteColor) { shade.Init(tri, setup); }
+
+	uint32 written = 0;
+	alignas(32) float ws[RASTER_LANES];
+
+	for(int32 y = startY; y < endY; ++y) {
+		int32 e0 = rowStart[0], e1 = rowStart[1], e2 = rowStart[2];
+		float* depthRow = depthBuffer + (size_t)y * stride;
+		uint32* colorRow = (Output != OUTPUT_DEPTH) ? colorBuffer + (size_t)y * stride : nullptr;
+		for(int32 x = startX; x < endX; x += RASTER_LANES, e0 += blockStep[0], e1 += blockStep[1], e2 += blockStep[2]) {
+			VInt edge0 = VAddInt(VSetInt(e0), offset0);
+			VInt edge1 = VAddInt(VSetInt(e1), offset1);
+			VInt edge2 = VAddInt(VSetInt(e2), offset2);
+
+			//coverage, a lane is inside when no edge function is negative
+			VFloat covered = VNonNegative(VOrInt(edge0, VOrInt(edge1, edge2)));
+			int32 mask = VBits(covered);
+			if(!mask) { continue; }
+
+			VFloat l1 = VMul(VToFloat(edge1), invArea);
+			VFloat l2 = VMul(VToFloat(edge2), invArea);
+			VFloat w = VAdd(w0, VAdd(VMul(l1, dw1), VMul(l2, dw2)));
+
+			//depth test, 1/w so larger is closer
+			float* depth = depthRow + x;
+			if(x + RASTER_LANES <= maxX) {
+				VFloat old = VLoad(depth);
+				VFloat pass = VAnd(covered, VGreater(w, old));
+				mask = VBits(pass);
+				if(!mask) { continue; }
+				VStore(depth, VSelect(pass, w, old));
+			} else {
+				//the last block of a row at the right edge of the buffer, lanes past it arent ours to touch
+				mask &= (1 << (maxX - x)) - 1;
+				VStore(ws, w);
+				for(int32 i = 0; i < RASTER_LANES; ++i) {
+					if(!(mask & (1 << i))) { continue; }
+					if(ws[i] > depth[i]) {
+						depth[i] = ws[i];
+					} else {
+						mask &= ~(1 << i);
+					}
+				}
+				if(!mask) { continue; }
+			}
+			for(int32 bits = mask; bits; bits &= bits - 1) { written++; }
+
+			if(Output == OUTPUT_ID) {
+				for(int32 i = 0; i < RASTER_LANES; ++i) {
+					if(mask & (1 << i)) { colorRow[x + i] = id; }
+				}
+			}
+
+			if(WriteColor) {
+				ShadeBlock(shade, l1, l2, w, mask, colorRow + x);
+			}
+		}
+		rowStart[0] += setup.stepY[0];
+		rowStart[1] += setup.stepY[1];
+		rowStart[2] += setup.stepY[2];
+	}
+	return written;
+}
+
+uint32 RasterizeTriangle(const RasterTriangle& tri, int32 minX, int32 minY, int32 maxX, int32 maxY,
+						 uint32* colorBuffer, float* depthBuffer, int32 stride) {
+	return ScanTriangle<OUTPUT_COLOR>(tri, 0, minX, minY, maxX, maxY, colorBuffer, depthBuffer, stride);
+}
+
+uint32 RasterizeDepth(const RasterTriangle& tri, int32 minX, int32 minY, int32 maxX, int32 maxY,
+					  float* depthBuffer, int32 stride) {
+	return ScanTriangle<OUTPUT_DEPTH>(tri, 0, minX, minY, maxX, maxY, nullptr, depthBuffer, stride);
+}
+
+uint32 RasterizeId(const RasterTriangle& tri, uint32 id, int32 minX, int32 minY, int32 maxX, int32 maxY,
+				   uint32* idBuffer, float* depthBuffer, int32 stride) {
+	return ScanTriangle<OUTPUT_ID>(tri, id, minX, minY, maxX, maxY, idBuffer, depthBuffer, stride);
+}
+
+//// Visibility Buffer ////
+
+//shades every pixel of the tile that has an id, each exactly once
+//a block of lanes is shaded once per distinct triangle in it, with the same integer edge functions and vector math
+//ScanTriangle uses, so the result matches shading while rasterizing
+//neighbouring blocks mostly share triangles, so setups are kept in a small cache keyed by id
+//returns the number of pixels shaded
+uint32 ResolveTile(const std::vector<RasterTriangle>& triangles, const uint32* idBuffer, uint32* colorBuffer,
+						  int32 minX, int32 minY, int32 maxX, int32 maxY, int32 stride) {
+	const int32 CACHE_SIZE = 16;
+	struct CachedSetup {
+		uint32 id = 0;
+		TriangleSetup setup;
+		ShadeSetup shade;
+		VFloat w0, dw1, dw2;
+		VInt offset1, offset2; //edge 1 and 2 across the lanes of a block
+	};
+	CachedSetup cache[CACHE_SIZE];
+
+	uint32 shaded = 0;
+	alignas(32) int32 laneOffsets[RASTER_LANES];
+	uint32 ids[RASTER_LANES];
+	for(int32 y = minY; y < maxY; ++y) {
+		const uint32* idRow = idBuffer + (size_t)y * stride;
+		uint32* colorRow = colorBuffer + (size_t)y * stride;
+		for(int32 x = minX; x < maxX; x += RASTER_LANES) {
+			//lanes past the right edge of the buffer are left out like empty pixels
+			int32 remaining = 0;
+			for(int32 i = 0; i < RASTER_LANES; ++i) {
+				ids[i] = (x + i < maxX) ? idRow[x + i] : 0;
+				remaining |= (ids[i] ? 1 : 0) << i;
+			}
+
+			while(remaining) {
+				uint32 id = 0;
+				int32 mask = 0;
+				for(int32 i = 0; i < RASTER_LANES; ++i) {
+					if(!(remaining & (1 << i))) { continue; }
+					if(!id) { id = ids[i]; }
+					if(ids[i] == id) { mask |= 1 << i; }
+				}
+				remaining &= ~mask;
+
+				CachedSetup& cached = cache[id % CACHE_SIZE];
+				if(cached.id != id) {
+					const RasterTriangle& tri = triangles[id - 1];
+					//it was rasterized, so its setup cant fail
+					SetupTriangle(tri, cached.setup);
+					cached.shade.Init(tri, cached.setup);
+					const Vector3* attr = cached.setup.attributes;
+					cached.w0 = VSet(attr[0].z); cached.dw1 = VSet(attr[1].z - attr[0].z); cached.dw2 = VSet(attr[2].z - attr[0].z);
+					for(int32 i = 0; i < RASTER_LANES; ++i) { laneOffsets[i] = cached.setup.stepX[1] * i; }
+					cached.offset1 = VLoadInt(laneOffsets);
+					for(int32 i = 0; i < RASTER_LANES; ++i) { laneOffsets[i] = cached.setup.stepX[2] * i; }
+					cached.offset2 = VLoadInt(laneOffsets);
+					cached.id = id;
+				}
+
+				VFloat invArea = VSet(cached.setup.invArea);
+				VFloat l1 = VMul(VToFloat(VAddInt(VSetInt(EdgeAt(cached.setup, 1, x, y)), cached.offset1)), invArea);
+				VFloat l2 = VMul(VToFloat(VAddInt(VSetInt(EdgeAt(cached.setup, 2, x, y)), cached.offset2)), invArea);
+				VFloat w = VAdd(cached.w0, VAdd(VMul(l1, cached.dw1), VMul(l2, cached.dw2)));
+				ShadeBlock(cached.shade, l1, l2, w, mask, colorRow + x);
+				for(int32 bits = mask; bits; bits &= bits - 1) { shaded++; }
+			}
+		}
+	}
+	return shaded;
+}
+
+} //namespace RASTER_NAMESPACE
+
+#undef RASTER_LANES
@@ -0,0 +1,99 @@
+#include "ShadowMap.h"
+#include "Rasterizer.h"
+#include "../math/Math.h"
+#include "../utils/ThreadPool.h"
+
+#include "../components/Mesh.h"
+
+//how far in world units a receiver has to be behind a caster to be in its shadow
+static const float SHADOW_BIAS = .05f;
+
+//Vector3::operator!= has a tolerance, but any change to the direction can move a shadow's edge by a texel
+bool ShadowMap::Changed(const Vector3& direction, int32 resolution, const std::vector<Mesh*>& casters, const std::vector<Matrix4>& models) const {
+	if(!valid || resolution != this->resolution) { return true; }
+	if(direction.x != lastDirection.x || direction.y != lastDirection.y || direction.z != lastDirection.z) { return true; }
+	if(casters != lastCasters) { return true; }
+	for(size_t i = 0; i < casters.size(); ++i) {
+		if(casters[i]->version != lastVersions[i] || models[i] != lastModels[i]) { return true; }
+	}
+	return false;
+}
+
+void ShadowMap::Render(const Vector3& direction, int32 resolution, const std::vector<Mesh*>& casters, const std::vector<Matrix4>& models, ThreadPool* pool) {
+	this->resolution = resolution;
+	lastDirection = direction;
+	lastCasters = casters;
+	lastModels = models;
+	lastVersions.resize(casters.size());
+	for(size_t i = 0; i < casters.size(); ++i) { lastVersions[i] = casters[i]->version; }
+	depth.assign((size_t)resolution * resolution, 0.f);
+	valid = !casters.empty() && direction.mag() > 0;
+	if(!valid) { return; }
+
+//// Light Space ////
+
+	//an orthonormal basis looking along the light, up is world up unless the light points nearly straight up or down
+	Vector3 forward = direction.normalized();
+	Vector3 up = (fabs(forward.y) > .99f) ? Vector3::FORWARD : Vector3::UP;
+	Vector3 right = up.trueCross(forward).normalized();
+	up = forward.trueCross(right);
+	Matrix4 basis(right.x, up.x, forward.x, 0,
+				  right.y, up.y, forward.y, 0,
+				  right.z, up.z, forward.z, 0,
+				  0,	   0,	 0,			1);
+
+	//the box around every caster's bounds in the light's basis
+	Vector3 boxMin( INFINITY,  INFINITY,  INFINITY);
+	Vector3 boxMax(-INFINITY, -INFINITY, -INFINITY);
+	for(size_t m = 0; m < casters.size(); ++m) {
+		Matrix4 toLight = lastModels[m] * basis;
+		const Mesh* mesh = casters[m];
+		for(int i = 0; i < 8; ++i) {
+			Vector3 corner((i & 1) ? mesh->boundsMax.x : mesh->boundsMin.x,
+						   (i & 2) ? mesh->boundsMax.y : mesh->boundsMin.y,
+						   (i & 4) ? mesh->boundsMax.z : mesh->boundsMin.z);
+			Vector3 p = corner * toLight;
+			boxMin = Vector3(std::min(boxMin.x, p.x), std::min(boxMin.y, p.y), std::min(boxMin.z, p.z));
+			boxMax = Vector3(std::max(boxMax.x, p.x), std::max(boxMax.y, p.y), std::max(boxMax.z, p.z));
+		}
+	}
+
+	//x and y across the texels, z flipped so the side nearest the light is 1
+	Vector3 size(std::max(boxMax.x - boxMin.x, 1e-4f), std::max(boxMax.y - boxMin.y, 1e-4f), std::max(boxMax.z - boxMin.z, 1e-4f));
+	float scaleX = resolution / size.x;
+	float scaleY = resolution / size.y;
+	float scaleZ = -1.f / size.z;
+	Matrix4 fit(scaleX, 0,		0,		0,
+				0,		scaleY, 0,		0,
+				0,		0,		scaleZ, 0,
+				-boxMin.x * scaleX, -boxMin.y * scaleY, -boxMax.z * scaleZ, 1);
+	lightMatrix = basis * fit;
+	bias = SHADOW_BIAS / size.z;
+
+//// Rasterize ////
+
+	//every caster's triangles through the light, both sides since a caster's back faces shadow just as well
+	std::vector<RasterTriangle> triangles;
+	for(size_t m = 0; m < casters.size(); ++m) {
+		Matrix4 toMap = lastModels[m] * lightMatrix;
+		const Mesh* mesh = casters[m];
+		for(size_t i = 0; i + 2 < mesh->indices.size(); i += 3) {
+			RasterTriangle rt;
+			for(int k = 0; k < 3; ++k) {
+				Vector3 p = mesh->vertices[mesh->indices[i + k]] * toMap;
+				rt.points[k] = Vector3(p.x, p.y, 0);
+				rt.texPoints[k] = Vector3(0, 0, p.z);
+			}
+			triangles.push_back(rt);
+		}
+	}
+
+	int32 bands = (resolution + BAND_HEIGHT - 1) / BAND_HEIGHT;
+	pool->ParallelFor(bands, [&](uint32 band) {
+		int32 minY = band * BAND_HEIGHT;
+		int32 maxY = std::min(minY + BAND_HEIGHT, resolution);
+		for(const RasterTriangle& rt : triangles) {
+			RasterizeDepth(rt, 0, minY, resolution, maxY, depth.data(), resolution);
+		}
+	});
+}
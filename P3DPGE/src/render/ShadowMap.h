@@ -0,0 +1,42 @@
+#pragma once
+#include "../math/Vector3.h"
+#include "../math/Matrix4.h"
+
+#include <vector>
+
+struct Mesh;
+struct ThreadPool;
+
+//a directional light's depth map, kept between frames and only rendered again when it would come out different
+//the light looks along its direction with an orthographic box fit around the shadow casting meshes
+//depth is 1 at the box's side facing the light and 0 at the far side so larger is closer like the other depth buffers,
+//and 0 where nothing was drawn
+struct ShadowMap {
+	static const int32 BAND_HEIGHT = 64; //rows per job when rendering
+
+	int32 resolution = 0;
+	std::vector<float> depth;
+	Matrix4 lightMatrix; //world space to (texel x, texel y, depth)
+	float bias = 0;		 //depth a receiver has to be behind a caster by to be shadowed, so surfaces dont shadow themselves
+	bool valid = false;  //false until the first render and whenever there are no casters
+
+	//what the map was last rendered from, compared each frame to tell if it changed
+	Vector3 lastDirection;
+	std::vector<Mesh*> lastCasters;
+	std::vector<Matrix4> lastModels;
+	std::vector<uint32> lastVersions; //each caster's Mesh::version, so a rebuilt mesh at the same address is noticed
+
+	//true if the light, the resolution or any shadow casting mesh's transform or buffers changed since the last render
+	//models holds each caster's local to world matrix
+	bool Changed(const Vector3& direction, int32 resolution, const std::vector<Mesh*>& casters, const std::vector<Matrix4>& models) const;
+
+	//fits the light's box around the casters and rasterizes them, bands of rows in parallel
+	void Render(const Vector3& direction, int32 resolution, const std::vector<Mesh*>& casters, const std::vector<Matrix4>& models, ThreadPool* pool);
+
+	//false if the point is behind something closer to the light, points outside the map are lit
+	//x, y and z are a point through lightMatrix
+	inline bool Lit(float x, float y, float z) const {
+		if(!(x >= 0 && y >= 0 && x < resolution && y < resolution)) { return true; }
+		return depth[(size_t)y * resolution + (size_t)x] <= z + bias;
+	}
+};
@@ -0,0 +1,309 @@
+#include "Texture.h"
+
+#include <algorithm>
+#include <climits>
+#include <unordered_map>
+
+static int32 NextPowerOfTwo(int32 n) {
+	int32 p = 1;
+	while(p < n) { p <<= 1; }
+	return p;
+}
+
+//copies a level stored row by row into its blocks
+static void Swizzle(const std::vector<uint32>& linear, Texture& texture, const Texture::Mip& mip) {
+	for(int32 y = 0; y < mip.height; ++y) {
+		for(int32 x = 0; x < mip.width; ++x) {
+			int32 block = (y / Texture::BLOCK_SIZE) * mip.blocksPerRow + (x / Texture::BLOCK_SIZE);
+			size_t index = mip.offset + block * Texture::BLOCK_SIZE * Texture::BLOCK_SIZE
+				+ (y % Texture::BLOCK_SIZE) * Texture::BLOCK_SIZE + (x % Texture::BLOCK_SIZE);
+			texture.texels[index] = linear[(size_t)y * mip.width + x];
+		}
+	}
+}
+
+//// Encoding ////
+
+static inline uint16 Encode565(uint32 pixel) {
+	olc::Pixel p(pixel);
+	return (uint16)((((p.r * 31 + 127) / 255) << 11) | (((p.g * 63 + 127) / 255) << 5) | ((p.b * 31 + 127) / 255));
+}
+
+static inline int32 ColorDistance(uint32 a, uint32 b) {
+	olc::Pixel p(a), q(b);
+	int32 dr = p.r - q.r, dg = p.g - q.g, db = p.b - q.b, da = p.a - q.a;
+	return dr * dr + dg * dg + db * db + da * da;
+}
+
+//median cut, the box of colors with the widest channel is split at its median along it until there are 256 boxes
+//or none can be split, then each box's average is a palette color
+static void BuildPalette(std::vector<uint32> colors, std::vector<uint32>& palette) {
+	auto channel = [](uint32 color, int32 c) { return (int32)((color >> (8 * c)) & 0xFF); };
+	struct Box {
+		size_t begin, end;
+		int32 channel, range; //the box's widest channel and how wide it is
+	};
+	auto makeBox = [&](size_t begin, size_t end) {
+		int32 lo[4] = { 255, 255, 255, 255 }, hi[4] = { 0, 0, 0, 0 };
+		for(size_t i = begin; i < end; ++i) {
+			for(int32 c = 0; c < 4; ++c) {
+				lo[c] = std::min(lo[c], channel(colors[i], c));
+				hi[c] = std::max(hi[c], channel(colors[i], c));
+			}
+		}
+		Box box = { begin, end, 0, hi[0] - lo[0] };
+		for(int32 c = 1; c < 4; ++c) {
+			if(hi[c] - lo[c] > box.range) { box.channel = c; box.range = hi[c] - lo[c]; }
+		}
+		return box;
+	};
+
+	std::vector<Box> boxes = { makeBox(0, colors.size()) };
+	while(boxes.size() < 256) {
+		size_t split = boxes.size();
+		int32 splitRange = 0;
+		for(size_t i = 0; i < boxes.size(); ++i) {
+			if(boxes[i].range > splitRange) { split = i; splitRange = boxes[i].range; }
+		}
+		if(split == boxes.size()) { break; } //every box is a single color
+
+		Box box = boxes[split];
+		size_t median = box.begin + (box.end - box.begin) / 2;
+		std::nth_element(colors.begin() + box.begin, colors.begin() + median, colors.begin() + box.end,
+						 [&](uint32 a, uint32 b) { return channel(a, box.channel) < channel(b, box.channel); });
+		boxes[split] = makeBox(box.begin, median);
+		boxes.push_back(makeBox(median, box.end));
+	}
+
+	palette.clear();
+	for(const Box& box : boxes) {
+		uint32 sum[4] = { 0, 0, 0, 0 };
+		for(size_t i = box.begin; i < box.end; ++i) {
+			for(int32 c = 0; c < 4; ++c) { sum[c] += channel(colors[i], c); }
+		}
+		uint32 count = (uint32)(box.end - box.begin);
+		uint32 color = 0;
+		for(int32 c = 0; c < 4; ++c) { color |= ((sum[c] + count / 2) / count) << (8 * c); }
+		palette.push_back(color);
+	}
+}
+
+//the endpoints are the block's extremes along the widest of its color channels' ranges, then each texel takes the nearest
+//of the four colors the block can make
+static Texture::BC1Block EncodeBC1(const uint32* texels) {
+	olc::Pixel lo(255, 255, 255), hi(0, 0, 0);
+	for(int32 i = 0; i < 16; ++i) {
+		olc::Pixel p(texels[i]);
+		lo.r = std::min(lo.r, p.r); lo.g = std::min(lo.g, p.g); lo.b = std::min(lo.b, p.b);
+		hi.r = std::max(hi.r, p.r); hi.g = std::max(hi.g, p.g); hi.b = std::max(hi.b, p.b);
+	}
+	int32 axis[3] = { hi.r - lo.r, hi.g - lo.g, hi.b - lo.b };
+	uint32 minTexel = texels[0], maxTexel = texels[0];
+	int32 minProjection = INT_MAX, maxProjection = INT_MIN;
+	for(int32 i = 0; i < 16; ++i) {
+		olc::Pixel p(texels[i]);
+		int32 projection = p.r * axis[0] + p.g * axis[1] + p.b * axis[2];
+		if(projection < minProjection) { minProjection = projection; minTexel = texels[i]; }
+		if(projection > maxProjection) { maxProjection = projection; maxTexel = texels[i]; }
+	}
+
+	Texture::BC1Block block;
+	block.color0 = Encode565(maxTexel);
+	block.color1 = Encode565(minTexel);
+	block.indices = 0;
+	if(block.color0 == block.color1) { return block; } //one color, every index picks color0
+	if(block.color0 < block.color1) { std::swap(block.color0, block.color1); }
+
+	uint32 colors[4];
+	for(uint32 select = 0; select < 4; ++select) { colors[select] = Texture::BC1Color(block, select); }
+	for(int32 i = 0; i < 16; ++i) {
+		uint32 best = 0;
+		int32 bestDistance = INT_MAX;
+		for(uint32 select = 0; select < 4; ++select) {
+			int32 distance = ColorDistance(texels[i] | 0xFF000000, colors[select]);
+			if(distance < bestDistance) { bestDistance = distance; best = select; }
+		}
+		block.indices |= best << (2 * i);
+	}
+	return block;
+}
+
+//// Loading ////
+
+Texture::Texture(olc::Sprite* sprite, Filter filter, Format format) {
+	this->filter = filter;
+	this->format = format;
+
+	int32 width = NextPowerOfTwo(std::max(sprite->width, 1));
+	int32 height = NextPowerOfTwo(std::max(sprite->height, 1));
+
+	//nearest resample into level 0, a no-op copy when the sprite is already a power of two
+	std::vector<uint32> linear((size_t)width * height);
+	for(int32 y = 0; y < height; ++y) {
+		for(int32 x = 0; x < width; ++x) {
+			linear[(size_t)y * width + x] = sprite->GetPixel(x * sprite->width / width, y * sprite->height / height).n;
+		}
+	}
+
+	//every level down to 1x1, blocks are padded out so levels smaller than a block still get a whole one
+	uint32 total = 0;
+	for(int32 w = width, h = height; ; w = std::max(w / 2, 1), h = std::max(h / 2, 1)) {
+		Mip mip;
+		mip.width = w;
+		mip.height = h;
+		mip.maskX = w - 1;
+		mip.maskY = h - 1;
+		mip.blocksPerRow = (w + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		mip.offset = total;
+		mips.push_back(mip);
+		total += mip.blocksPerRow * ((h + BLOCK_SIZE - 1) / BLOCK_SIZE) * BLOCK_SIZE * BLOCK_SIZE;
+		if(w == 1 && h == 1) { break; }
+	}
+	texels.resize(total);
+
+	//the palette is picked from the full size level, the smaller ones are averages of it
+	if(format == FORMAT_PAL8) { BuildPalette(linear, palette); }
+
+	Swizzle(linear, *this, mips[0]);
+	for(size_t level = 1; level < mips.size(); ++level) {
+		const Mip& prev = mips[level - 1];
+		const Mip& mip = mips[level];
+		std::vector<uint32> next((size_t)mip.width * mip.height);
+
+		//box filter, a dimension already at 1 just averages the same texel with itself
+		for(int32 y = 0; y < mip.height; ++y) {
+			for(int32 x = 0; x < mip.width; ++x) {
+				int32 x0 = std::min(2 * x, prev.maskX), x1 = std::min(2 * x + 1, prev.maskX);
+				int32 y0 = std::min(2 * y, prev.maskY), y1 = std::min(2 * y + 1, prev.maskY);
+				olc::Pixel a(linear[(size_t)y0 * prev.width + x0]);
+				olc::Pixel b(linear[(size_t)y0 * prev.width + x1]);
+				olc::Pixel c(linear[(size_t)y1 * prev.width + x0]);
+				olc::Pixel d(linear[(size_t)y1 * prev.width + x1]);
+				next[(size_t)y * mip.width + x] = olc::Pixel((a.r + b.r + c.r + d.r + 2) / 4, (a.g + b.g + c.g + d.g + 2) / 4,
+															 (a.b + b.b + c.b + d.b + 2) / 4, (a.a + b.a + c.a + d.a + 2) / 4).n;
+			}
+		}
+		Swizzle(next, *this, mip);
+		linear.swap(next);
+	}
+
+	//every format shares the block order, so the rgba texels convert one for one (or a block at a time for BC1)
+	switch(format) {
+		case FORMAT_RGBA32: return;
+		case FORMAT_RGB565: {
+			texels565.resize(texels.size());
+			for(size_t i = 0; i < texels.size(); ++i) { texels565[i] = Encode565(texels[i]); }
+		} break;
+		case FORMAT_PAL8: {
+			//textures that suit a palette repeat their colors a lot, so each distinct one is only searched for once
+			std::unordered_map<uint32, uint8> nearest;
+			indices.resize(texels.size());
+			for(size_t i = 0; i < texels.size(); ++i) {
+				auto it = nearest.find(texels[i]);
+				if(it == nearest.end()) {
+					uint8 best = 0;
+					int32 bestDistance = INT_MAX;
+					for(size_t c = 0; c < palette.size(); ++c) {
+						int32 distance = ColorDistance(texels[i], palette[c]);
+						if(distance < bestDistance) { bestDistance = distance; best = (uint8)c; }
+					}
+					it = nearest.insert(std::make_pair(texels[i], best)).first;
+				}
+				indices[i] = it->second;
+			}
+		} break;
+		case FORMAT_BC1: {
+			blocks.resize(texels.size() / (BLOCK_SIZE * BLOCK_SIZE));
+			for(size_t i = 0; i < blocks.size(); ++i) { blocks[i] = EncodeBC1(&texels[i * BLOCK_SIZE * BLOCK_SIZE]); }
+		} break;
+		default: break;
+	}
+	std::vector<uint32>().swap(texels); //the rgba copy is only kept when its the format
+}
+
+const char* Texture::FormatName(Format format) {
+	switch(format) {
+		case FORMAT_RGBA32: return "rgba32";
+		case FORMAT_RGB565: return "rgb565";
+		case FORMAT_PAL8:	return "pal8";
+		case FORMAT_BC1:	return "bc1";
+		default:			return "unknown";
+	}
+}
+
+size_t Texture::Bytes() const {
+	return texels.size() * sizeof(uint32) + texels565.size() * sizeof(uint16) + indices.size() * sizeof(uint8)
+		 + palette.size() * sizeof(uint32) + blocks.size() * sizeof(BC1Block);
+}
+
+int32 Texture::SelectMip(const Vector3 points[3], const Vector3 texPoints[3]) const {
+	//undo the perspective divide on the texture coordinates, then compare the triangle's area in texels to its area in pixels
+	//its one level for the whole triangle, so steep triangles are blurrier up close and sharper far away than per pixel lod
+	float u[3], v[3];
+	for(int i = 0; i < 3; ++i) {
+		u[i] = texPoints[i].x / texPoints[i].z * mips[0].width;
+		v[i] = texPoints[i].y / texPoints[i].z * mips[0].height;
+	}
+	float texelArea = fabs((u[1] - u[0]) * (v[2] - v[0]) - (u[2] - u[0]) * (v[1] - v[0]));
+	float pixelArea = fabs((points[1].x - points[0].x) * (points[2].y - points[0].y) - (points[2].x - points[0].x) * (points[1].y - points[0].y));
+	if(!(texelArea > pixelArea)) { return 0; } //magnified, or degenerate
+
+	//texels per pixel along a side is the square root of the area ratio, so the level is half its log2
+	int32 level = (int32)(.5f * log2f(texelArea / pixelArea));
+	return std::min(level, (int32)mips.size() - 1);
+}
+
+//// Sampling ////
+
+template<Texture::Format F>
+static inline uint32 SampleNearestAs(const Texture& texture, int32 level, float u, float v) {
+	const Texture::Mip& mip = texture.mips[level];
+	return texture.Fetch<F>(mip, (int32)floorf(u * mip.width), (int32)floorf(v * mip.height));
+}
+
+//lerps all four channels of two packed texels at once, red/blue and green/alpha each fit in a register with room to multiply
+static inline uint32 LerpTexels(uint32 a, uint32 b, uint32 weight) {
+	uint32 rbA = a & 0x00FF00FF, agA = (a >> 8) & 0x00FF00FF;
+	uint32 rbB = b & 0x00FF00FF, agB = (b >> 8) & 0x00FF00FF;
+	uint32 rb = ((rbA * (256 - weight) + rbB * weight) >> 8) & 0x00FF00FF;
+	uint32 ag = (agA * (256 - weight) + agB * weight) & 0xFF00FF00;
+	return rb | ag;
+}
+
+template<Texture::Format F>
+static inline uint32 SampleBilinearAs(const Texture& texture, int32 level, float u, float v) {
+	const Texture::Mip& mip = texture.mips[level];
+
+	//texel centers are at half coordinates, weights are 8 bit fixed point
+	float x = u * mip.width - .5f;
+	float y = v * mip.height - .5f;
+	float fx = floorf(x);
+	float fy = floorf(y);
+	int32 x0 = (int32)fx;
+	int32 y0 = (int32)fy;
+	uint32 wx = (uint32)((x - fx) * 256.f);
+	uint32 wy = (uint32)((y - fy) * 256.f);
+
+	uint32 top = LerpTexels(texture.Fetch<F>(mip, x0, y0), texture.Fetch<F>(mip, x0 + 1, y0), wx);
+	uint32 bottom = LerpTexels(texture.Fetch<F>(mip, x0, y0 + 1), texture.Fetch<F>(mip, x0 + 1, y0 + 1), wx);
+	return LerpTexels(top, bottom, wy);
+}
+
+//the format is the same for every sample of a texture, so the branch is always predicted
+uint32 Texture::SampleNearest(int32 level, float u, float v) const {
+	switch(format) {
+		case FORMAT_RGB565: return SampleNearestAs<FORMAT_RGB565>(*this, level, u, v);
+		case FORMAT_PAL8:	return SampleNearestAs<FORMAT_PAL8>(*this, level, u, v);
+		case FORMAT_BC1:	return SampleNearestAs<FORMAT_BC1>(*this, level, u, v);
+		default:			return SampleNearestAs<FORMAT_RGBA32>(*this, level, u, v);
+	}
+}
+
+uint32 Texture::SampleBilinear(int32 level, float u, float v) const {
+	switch(format) {
+		case FORMAT_RGB565: return SampleBilinearAs<FORMAT_RGB565>(*this, level, u, v);
+		case FORMAT_PAL8:	return SampleBilinearAs<FORMAT_PAL8>(*this, level, u, v);
+		case FORMAT_BC1:	return SampleBilinearAs<FORMAT_BC1>(*this, level, u, v);
+		default:			return SampleBilinearAs<FORMAT_RGBA32>(*this, level, u, v);
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "../math/Vector3.h"
+
+#include <vector>
+#include <utility>
+
+//a texture converted for the rasterizer when its loaded, instead of sampling olc::Sprite directly
+//sizes are rounded up to powers of two so wrapping is a mask, a full mip chain is built by box filtering,
+//and every level is stored in 4x4 texel blocks so the texels a pixel's neighbors read are usually in the same cache line
+//the blocks can be stored in a smaller format to cut the memory the sampler reads, they're decoded to rgba as they're fetched
+struct Texture {
+	enum Filter : uint8 { FILTER_NEAREST, FILTER_BILINEAR };
+
+	//how the texels are stored, picked when the texture is loaded
+	enum Format : uint8 {
+		FORMAT_RGBA32,	//olc::Pixel's packed rgba, exact
+		FORMAT_RGB565,	//16 bits a texel, alpha is dropped
+		FORMAT_PAL8,	//8 bit indices into a palette of up to 256 colors picked by median cut, for textures with few colors
+		FORMAT_BC1,		//each 4x4 block is two 565 colors and 2 bit indices picking between them and two blends of them, 4 bits a texel, alpha is dropped
+		FORMAT_COUNT
+	};
+
+	static const int32 BLOCK_SIZE = 4; //texels per block side, 16 32bit texels is one 64 byte cache line
+
+	struct Mip {
+		int32 width, height;
+		int32 maskX, maskY;		//width - 1 and height - 1, wrapping is a bitwise and
+		int32 blocksPerRow;
+		uint32 offset;			//index of the level's first texel, in texels of every format
+	};
+
+	//a BC1 block, same bit layout as the GPU format
+	struct BC1Block {
+		uint16 color0, color1;	//565, color0 > color1 so the block always uses the 4 color mode
+		uint32 indices;			//2 bits per texel, row by row from the low bits
+	};
+
+	//only the format's storage is filled, every level back to back
+	std::vector<uint32> texels;		//FORMAT_RGBA32
+	std::vector<uint16> texels565;	//FORMAT_RGB565
+	std::vector<uint8> indices;		//FORMAT_PAL8
+	std::vector<uint32> palette;	//FORMAT_PAL8's colors as olc::Pixel's packed rgba
+	std::vector<BC1Block> blocks;	//FORMAT_BC1, one per BLOCK_SIZE * BLOCK_SIZE texels
+
+	std::vector<Mip> mips;		//level 0 is the full size texture
+	Filter filter = FILTER_BILINEAR;
+	Format format = FORMAT_RGBA32;
+
+	//copies the sprite, resampling it to the next power of two when its not one already
+	Texture(olc::Sprite* sprite, Filter filter = FILTER_BILINEAR, Format format = FORMAT_RGBA32);
+
+	static const char* FormatName(Format format);
+
+	//bytes of texel storage across every level
+	size_t Bytes() const;
+
+	//the mip level a triangle should sample, from how many texels cover a pixel on average across it
+	//points are in screen space and texPoints are u/w, v/w, 1/w like RasterTriangle's
+	int32 SelectMip(const Vector3 points[3], const Vector3 texPoints[3]) const;
+
+	//u and v are in [0, 1) over the texture and wrap outside of it, returns olc::Pixel's packed rgba
+	uint32 SampleNearest(int32 level, float u, float v) const;
+	uint32 SampleBilinear(int32 level, float u, float v) const;
+
+	//texel x, y of a level wrapped into it, as olc::Pixel's packed rgba
+	template<Format F>
+	inline uint32 Fetch(const Mip& mip, int32 x, int32 y) const;
+
+	//index of the texel x, y of a level wrapped into it, in the block order every format is stored in
+	inline uint32 TexelIndex(const Mip& mip, int32 x, int32 y) const {
+		uint32 ux = (uint32)x & mip.maskX;
+		uint32 uy = (uint32)y & mip.maskY;
+		uint32 block = (uy / BLOCK_SIZE) * mip.blocksPerRow + (ux / BLOCK_SIZE);
+		return mip.offset + block * BLOCK_SIZE * BLOCK_SIZE + (uy % BLOCK_SIZE) * BLOCK_SIZE + (ux % BLOCK_SIZE);
+	}
+
+	//a 565 color widened to olc::Pixel's packed rgba, opaque
+	static inline uint32 Decode565(uint16 c) {
+		uint32 r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+		return ((r << 3) | (r >> 2)) | (((g << 2) | (g >> 4)) << 8) | (((b << 3) | (b >> 2)) << 16) | 0xFF000000;
+	}
+
+	//one of the four colors a BC1 block can make, as olc::Pixel's packed rgba
+	static inline uint32 BC1Color(const BC1Block& block, uint32 select) {
+		uint32 a = Decode565(block.color0);
+		if(select == 0) { return a; }
+		uint32 b = Decode565(block.color1);
+		if(select == 1) { return b; }
+
+		//the blends are 2/3 of one endpoint and 1/3 of the other
+		if(select == 3) { std::swap(a, b); }
+		uint32 r = (2 * (a & 0xFF) + (b & 0xFF)) / 3;
+		uint32 g = (2 * ((a >> 8) & 0xFF) + ((b >> 8) & 0xFF)) / 3;
+		uint32 bl = (2 * ((a >> 16) & 0xFF) + ((b >> 16) & 0xFF)) / 3;
+		return r | (g << 8) | (bl << 16) | 0xFF000000;
+	}
+};
+
+template<>
+inline uint32 Texture::Fetch<Texture::FORMAT_RGBA32>(const Mip& mip, int32 x, int32 y) const {
+	return texels[TexelIndex(mip, x, y)];
+}
+
+template<>
+inline uint32 Texture::Fetch<Texture::FORMAT_RGB565>(const Mip& mip, int32 x, int32 y) const {
+	return Decode565(texels565[TexelIndex(mip, x, y)]);
+}
+
+template<>
+inline uint32 Texture::Fetch<Texture::FORMAT_PAL8>(const Mip& mip, int32 x, int32 y) const {
+	return palette[indices[TexelIndex(mip, x, y)]];
+}
+
+template<>
+inline uint32 Texture::Fetch<Texture::FORMAT_BC1>(const Mip& mip, int32 x, int32 y) const {
+	uint32 index = TexelIndex(mip, x, y);
+	const BC1Block& block = blocks[index / (BLOCK_SIZE * BLOCK_SIZE)];
+	return BC1Color(block, (block.indices >> (2 * (index % (BLOCK_SIZE * BLOCK_SIZE)))) & 3);
+}
@@ -0,0 +1,67 @@
+#include "VertexStage.h"
+#include "../math/Math.h"
+#include "../utils/ThreadPool.h"
+#include "../EntityAdmin.h"
+
+#include "../components/Mesh.h"
+#include "../components/Camera.h"
+#include "../components/Screen.h"
+#include "../components/Transform.h"
+
+Matrix4 VertexStage::ModelMatrix(Mesh* mesh) {
+	//the same transform MeshSystem applies to the triangles' points, meshes without a Transform stay in local space
+	if(mesh->entity) {
+		for(Component* c : mesh->entity->components) {
+			if(Transform* t = dynamic_cast<Transform*>(c)) {
+				return Matrix4::RotationMatrix(t->rotation) * Matrix4::TranslationMatrix(t->position);
+			}
+		}
+	}
+	return Matrix4::IDENTITY;
+}
+
+void VertexStage::Run(ThreadPool* pool, const std::vector<MeshInstance>& meshes, Camera* camera, Screen* screen) {
+	meshOffsets.clear();
+	modelViews.clear();
+	batches.clear();
+
+	uint32 total = 0;
+	for(uint32 m = 0; m < meshes.size(); ++m) {
+		const MeshInstance& instance = meshes[m];
+		modelViews.push_back(instance.model * camera->viewMatrix);
+		meshOffsets.push_back(total);
+
+		uint32 count = (uint32)instance.mesh->LODVertices(instance.lodLevel).size();
+		for(uint32 first = 0; first < count; first += BATCH_SIZE) {
+			batches.push_back({m, first, std::min(BATCH_SIZE, count - first)});
+		}
+		total += count;
+	}
+	vertices.resize(total);
+
+	float nearZ = camera->nearZ;
+	const Matrix4& proj = camera->projectionMatrix;
+	float halfWidth = .5f * screen->width;
+	float halfHeight = .5f * screen->height;
+	pool->ParallelFor((uint32)batches.size(), [&](uint32 b) {
+		const Batch& batch = batches[b];
+		const Matrix4& mv = modelViews[batch.mesh];
+		const MeshInstance& instance = meshes[batch.mesh];
+		const Vector3* in = instance.mesh->LODVertices(instance.lodLevel).data() + batch.first;
+		ProjectedVertex* out = vertices.data() + meshOffsets[batch.mesh] + batch.first;
+
+		//a flat loop over a contiguous run with the matrices hoisted, so the compiler can vectorize it
+		for(uint32 i = 0; i < batch.count; ++i) {
+			Vector3 c = in[i] * mv;
+			out[i].camera = c;
+
+			//vertices in front of the near plane are projected here, the rest only exist as clipped points
+			if(c.z >= nearZ) {
+				Vector4 clip = Vector4(c.x, c.y, c.z, 1.f) * proj;
+				float invW = 1.f / clip.w;
+				out[i].screen = Vector3((clip.x * invW + 1.f) * halfWidth, (clip.y * invW + 1.f) * halfHeight, clip.z * invW);
+				out[i].invW = invW;
+			}
+		}
+	});
+}
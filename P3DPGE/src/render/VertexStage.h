@@ -0,0 +1,72 @@
+#pragma once
+#include "../math/Vector3.h"
+#include "../math/Matrix4.h"
+
+#include <vector>
+
+struct Mesh;
+struct Camera;
+struct Screen;
+struct ThreadPool;
+
+//a mesh as it was when the frame was extracted, the render thread reads these instead of the mesh's entity
+//so the next frame's simulation can move it while this one is drawn
+struct MeshInstance {
+	Mesh* mesh;		//only its buffers, triangle colors and texture are read, which dont change after loading
+	Matrix4 model;	//local to world
+	uint32 lodLevel;
+	bool occluder;
+};
+
+//a mesh vertex after the vertex stage
+struct ProjectedVertex {
+	Vector3 camera;	//view space
+	Vector3 screen;	//pixels, only valid when camera.z is past the near plane
+	float invW;		//1/w for perspective correct interpolation, same condition as screen
+};
+
+//transforms every unique vertex of every mesh's current level of detail to camera and screen space once per frame
+//so triangle setup just indexes into the results instead of transforming each corner again
+struct VertexStage {
+	static const uint32 BATCH_SIZE = 2048; //vertices per job handed to the pool
+
+	//a run of one mesh's vertices that a single job transforms
+	struct Batch {
+		uint32 mesh;
+		uint32 first;
+		uint32 count;
+	};
+
+	std::vector<ProjectedVertex> vertices;	//every mesh's vertices back to back
+	std::vector<uint32> meshOffsets;		//index of each mesh's first vertex in vertices
+	std::vector<Matrix4> modelViews;		//per mesh, its model matrix followed by the camera's view
+	std::vector<Batch> batches;
+
+	//the mesh's local to world matrix from its entity's Transform, identity if it has none
+	static Matrix4 ModelMatrix(Mesh* mesh);
+
+	//the camera's position in a mesh's local space from its model view matrix, for back-face culling against its FacePlanes
+	//the camera is the view space origin, so this solves eye * A + t = 0 for the matrix's 3x3 part A and translation t
+	//the view matrix from LookAtMatrix isnt always orthonormal, so A is inverted in full rather than transposed
+	static Vector3 LocalEye(const Matrix4& modelView) {
+		const float* m = modelView.data;
+		float a = m[0], b = m[1], c = m[2];
+		float d = m[4], e = m[5], f = m[6];
+		float g = m[8], h = m[9], i = m[10];
+
+		//adjugate of A, row major
+		float i00 = e * i - f * h, i01 = c * h - b * i, i02 = b * f - c * e;
+		float i10 = f * g - d * i, i11 = a * i - c * g, i12 = c * d - a * f;
+		float i20 = d * h - e * g, i21 = b * g - a * h, i22 = a * e - b * d;
+		float det = a * i00 + b * i10 + c * i20;
+		if(det == 0) { return Vector3::ZERO; }
+
+		float x = -m[12] / det, y = -m[13] / det, z = -m[14] / det;
+		return Vector3(x * i00 + y * i10 + z * i20,
+					   x * i01 + y * i11 + z * i21,
+					   x * i02 + y * i12 + z * i22);
+	}
+
+	//all of the buffers keep their memory between frames
+	void Run(ThreadPool* pool, const std::vector<MeshInstance>& meshes, Camera* camera, Screen* screen);
+};
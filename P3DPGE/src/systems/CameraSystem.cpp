@@ -79,6 +79,8 @@ void CameraSystem::Update() {
 	if (USE_ORTHO) camera->projectionMatrix = MakeOrthoProjectionMatrix(scene, camera, screen);
 	else		   camera->projectionMatrix = MakeProjectionMatrix(camera, screen);
 
-	admin->p->DrawStringDecal(olc::vf2d(screen->width-300, screen->height - 30), "Camera Pos: " + camera->position.str2f());
-	admin->p->DrawStringDecal(olc::vf2d(screen->width-300, screen->height - 40), "Camera Rot: " + camera->target.str2f());
+	if(admin->p) {
+		admin->p->DrawStringDecal(olc::vf2d(screen->width-300, screen->height - 30), "Camera Pos: " + camera->position.str2f());
+		admin->p->DrawStringDecal(olc::vf2d(screen->width-300, screen->height - 40), "Camera Rot: " + camera->target.str2f());
+	}
 }
\ No newline at end of file
@@ -1,9 +1,11 @@
 #include "CommandSystem.h"
 #include "../utils/Command.h"
+#include "../utils/Benchmark.h"
 #include "../ui/UI.h"
 #include "../ui/UIContainer.h"
 
 #include "../systems/WorldSystem.h"
+#include "../systems/RenderSceneSystem.h"
 
 #include "../components/Input.h"
 #include "../components/Keybinds.h"
@@ -11,6 +13,7 @@
 #include "../components/Transform.h"
 #include "../components/Mesh.h"
 #include "../components/Scene.h"
+#include "../components/Screen.h"
 #include "../components/Physics.h"
 #include "../components/Collider.h"
 #include "../components/Source.h"
@@ -115,7 +118,9 @@ inline void AddSpawnCommands(EntityAdmin* admin) {
 
 		Transform* t = new Transform(Vector3(0,0,3), Vector3::ZERO, Vector3::ONE);
 		Mesh* m = Mesh::CreateComplex(c, "objects/whale_ship.obj", false, t->position);
-		WorldSystem::AddComponentsToEntity(c, {t, m});
+		Physics* p = new Physics(t->position, t->rotation, Vector3::ZERO, Vector3::ZERO, Vector3::ZERO, Vector3::ZERO, 0, 1, true);
+		MeshCollider* col = new MeshCollider(c, m->triangles);
+		WorldSystem::AddComponentsToEntity(c, {t, m, p, col});
 		admin->input->selectedEntity = c;
 		return "";
 	}, "spawn_complex1", "spawn_box <filePath: String> <hasTexture: Boolean> <position: Vector3> [rotation: Vector3] [scale: Vector3]");
@@ -130,6 +135,28 @@ inline void AddSpawnCommands(EntityAdmin* admin) {
 		return "";
 	}, "spawn_complex2", "spawn_box <filePath: String> <hasTexture: Boolean> <position: Vector3> [rotation: Vector3] [scale: Vector3]");
 
+	admin->commands["spawn_hull"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		std::string file = (args.size() > 0) ? args[0] : "objects/bmonkey.obj";
+		uint32 maxVertices = 0;
+		if(args.size() > 1 && std::regex_match(args[1], std::regex("[0-9]+"))) {
+			maxVertices = std::stoi(args[1]);
+		}
+
+		Entity* c = WorldSystem::CreateEntity(admin);
+		Transform* t = new Transform(Vector3(0,0,3), Vector3::ZERO, Vector3::ONE);
+		Mesh* m = Mesh::CreateComplex(c, file.c_str(), false, t->position);
+		if(!m) { return "[c:red]Failed to load " + file + "[c]"; }
+		ConvexPolyCollider* col = ConvexPolyCollider::FromMesh(c, m->triangles, file, 1, maxVertices);
+		if(!col) {
+			WorldSystem::AddComponentsToEntity(c, {t, m});
+			return "[c:red]" + file + " is too flat to make a hull from, spawned it without a collider[c]";
+		}
+		Physics* p = new Physics(t->position, t->rotation);
+		WorldSystem::AddComponentsToEntity(c, {t, m, p, col});
+		admin->input->selectedEntity = c;
+		return TOSTRING("hull with ", col->vertices.size(), " vertices created from ", file);
+	}, "spawn_hull", "spawn_hull [filePath: String] [maxVertices: Int]; spawns a mesh with a convex hull collider, cached next to the file as .hull");
+
 	admin->commands["spawn_scene"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
 		Entity* c = WorldSystem::CreateEntity(admin);
 
@@ -137,10 +164,10 @@ inline void AddSpawnCommands(EntityAdmin* admin) {
 		Mesh* m = Mesh::CreateComplex(c, "scenes/scene_test.obj", true, t->position);
 		WorldSystem::AddComponentsToEntity(c, { t, m });
 
-		olc::Sprite* s = new olc::Sprite(1, 1);
-		s->SetPixel(Vector2(0, 0), olc::WHITE);
+		olc::Sprite s(1, 1);
+		s.SetPixel(Vector2(0, 0), olc::WHITE);
 
-		m->texture = s;
+		m->texture = new Texture(&s);
 
 		admin->input->selectedEntity = c;
 		return "";
@@ -220,6 +247,107 @@ inline void AddRenderCommands(EntityAdmin* admin) {
 		if (admin->currentScene->RENDER_MESH_NORMALS) return "render_mesh_normals = true";
 		else return "render_mesh_normals = false";
 	}, "r_mesh_normals", "toggles rendering mesh normals");
+
+	admin->commands["r_mesh_bounds"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		admin->currentScene->RENDER_MESH_BOUNDS = !admin->currentScene->RENDER_MESH_BOUNDS;
+		if (admin->currentScene->RENDER_MESH_BOUNDS) return "render_mesh_bounds = true";
+		else return "render_mesh_bounds = false";
+	}, "r_mesh_bounds", "toggles rendering the bounding box and sphere of meshes in view");
+
+	admin->commands["r_occlusion_culling"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		admin->currentScene->OCCLUSION_CULLING = !admin->currentScene->OCCLUSION_CULLING;
+		if (admin->currentScene->OCCLUSION_CULLING) return "occlusion_culling = true";
+		else return "occlusion_culling = false";
+	}, "r_occlusion_culling", "toggles skipping meshes hidden behind occluders");
+
+	admin->commands["r_lod"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		admin->currentScene->LEVEL_OF_DETAIL = !admin->currentScene->LEVEL_OF_DETAIL;
+		if (admin->currentScene->LEVEL_OF_DETAIL) return "level_of_detail = true";
+		else return "level_of_detail = false";
+	}, "r_lod", "toggles drawing simplified meshes when they're small on screen");
+
+	admin->commands["r_shadows"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		admin->currentScene->RENDER_SHADOWS = !admin->currentScene->RENDER_SHADOWS;
+		if (admin->currentScene->RENDER_SHADOWS) return "render_shadows = true";
+		else return "render_shadows = false";
+	}, "r_shadows", "toggles shadows from the scene's lights");
+
+	admin->commands["r_visibility"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		admin->currentScene->VISIBILITY_BUFFER = !admin->currentScene->VISIBILITY_BUFFER;
+		if (admin->currentScene->VISIBILITY_BUFFER) return "visibility_buffer = true";
+		else return "visibility_buffer = false";
+	}, "r_visibility", "toggles rasterizing triangle ids and shading each visible pixel once afterwards");
+
+	admin->commands["r_thread"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		admin->currentScene->RENDER_THREADED = !admin->currentScene->RENDER_THREADED;
+		if (admin->currentScene->RENDER_THREADED) return "render_threaded = true";
+		else return "render_threaded = false";
+	}, "r_thread", "toggles rendering each frame on its own thread while the next frame is simulated, which shows frames one late");
+
+	admin->commands["r_dynres"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		admin->currentScene->DYNAMIC_RESOLUTION = !admin->currentScene->DYNAMIC_RESOLUTION;
+		if (admin->currentScene->DYNAMIC_RESOLUTION) return "dynamic_resolution = true";
+		else return "dynamic_resolution = false";
+	}, "r_dynres", "toggles lowering the resolution the scene is rasterized at to keep the raster stage under r_dynres_target");
+
+	admin->commands["r_dynres_target"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		DynamicResolution& resolution = admin->GetSystem<RenderSceneSystem>()->resolution;
+		if (args.size() > 0) {
+			if (!std::regex_match(args[0], std::regex("[0-9]*\\.?[0-9]+")) || std::stof(args[0]) <= 0) {
+				return "[c:red]Invalid target: " + args[0] + "[c]";
+			}
+			resolution.targetMS = std::stof(args[0]);
+		}
+		return TOSTRING("dynamic resolution target = ", resolution.targetMS, " ms");
+	}, "r_dynres_target", "r_dynres_target [ms]\nsets the raster time the dynamic resolution aims to stay under, prints it when no time is given");
+
+	admin->commands["r_dynres_bounds"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		DynamicResolution& resolution = admin->GetSystem<RenderSceneSystem>()->resolution;
+		if (args.size() > 0) {
+			std::regex fraction("0?\\.[0-9]+|1(\\.0*)?");
+			if (args.size() < 2 || !std::regex_match(args[0], fraction) || !std::regex_match(args[1], fraction)) {
+				return "[c:red]Bounds must be two scales between 0 and 1[c]";
+			}
+			float minScale = std::stof(args[0]);
+			float maxScale = std::stof(args[1]);
+			if (minScale <= 0 || minScale > maxScale) {
+				return "[c:red]The min scale has to be above 0 and at most the max scale[c]";
+			}
+			resolution.minScale = minScale;
+			resolution.maxScale = maxScale;
+			resolution.Reset();
+		}
+		return TOSTRING("dynamic resolution bounds = ", resolution.minScale, " to ", resolution.maxScale, " of the screen");
+	}, "r_dynres_bounds", "r_dynres_bounds [min] [max]\nsets the smallest and largest fraction of the screen's resolution the dynamic resolution can pick, prints them when none are given");
+
+	admin->commands["r_reuse"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		admin->currentScene->REUSE_FRAMES = !admin->currentScene->REUSE_FRAMES;
+		if (admin->currentScene->REUSE_FRAMES) return "reuse_frames = true";
+		else return "reuse_frames = false";
+	}, "r_reuse", "toggles showing the last frame again instead of drawing it when the camera, meshes, lights and render options havent changed");
+
+	admin->commands["r_idle_throttle"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		admin->currentScene->IDLE_THROTTLE = !admin->currentScene->IDLE_THROTTLE;
+		if (admin->currentScene->IDLE_THROTTLE) return "idle_throttle = true";
+		else return "idle_throttle = false";
+	}, "r_idle_throttle", "toggles slowing the engine down to about 30 frames a second while frames are being reused");
+
+	admin->commands["r_stats"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		RenderSceneSystem* render = admin->GetSystem<RenderSceneSystem>();
+		return render->counters.str(render->timings);
+	}, "r_stats", "prints how long each render stage of the last frame took and what it culled, clipped and drew");
+
+	admin->commands["r_occluder"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		if(!admin->input->selectedEntity) { return "[c:red]No entity selected[c]"; }
+		for(Component* comp : admin->input->selectedEntity->components) {
+			if(Mesh* mesh = dynamic_cast<Mesh*>(comp)) {
+				mesh->occluder = !mesh->occluder;
+				if (mesh->occluder) return "occluder = true";
+				else return "occluder = false";
+			}
+		}
+		return "[c:red]Selected entity has no mesh[c]";
+	}, "r_occluder", "toggles whether the selected entity's mesh hides meshes behind it");
 }
 
 inline void AddConsoleCommands(EntityAdmin* admin) {
@@ -257,6 +385,12 @@ inline void AddConsoleCommands(EntityAdmin* admin) {
 		if (admin->tempCanvas->SHOW_FPS_GRAPH) return "showing FPS graph";
 		else return "hiding fps graph";
 		}, "ui_fps_graph", "displays the FPS graph menu");
+
+	admin->commands["ui_render_stats"] = new Command([](EntityAdmin* admin, std::vector<std::string> args)->std::string {
+		admin->tempCanvas->SHOW_RENDER_STATS = !admin->tempCanvas->SHOW_RENDER_STATS;
+		if (admin->tempCanvas->SHOW_RENDER_STATS) return "showing render stats";
+		else return "hiding render stats";
+		}, "ui_render_stats", "displays the render stage timings and counters");
 }
 
 inline void HandleMouseInputs(EntityAdmin* admin, Input* input) {
@@ -401,6 +535,55 @@ inline void HandleRenderInputs(EntityAdmin* admin, Input* input, Keybinds* binds
 	}
 }
 
+inline void AddBenchmarkCommands(EntityAdmin* admin) {
+	admin->commands["bench_physics"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		uint32 repeat = 1;
+		if (args.size() > 0 && std::regex_match(args[0], std::regex("[0-9]+"))) {
+			repeat = std::stoi(args[0]);
+		}
+		std::string results = Benchmark::Physics(repeat);
+		std::ofstream file("bench_physics.json");
+		file << results;
+		return "physics benchmark written to bench_physics.json";
+	}, "bench_physics", "bench_physics [repeat]\nruns the headless physics scenes for their tick counts repeat times over and writes the results to bench_physics.json");
+
+	admin->commands["bench_render"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		uint32 frames = 120;
+		if (args.size() > 0 && std::regex_match(args[0], std::regex("[0-9]+"))) {
+			frames = std::stoi(args[0]);
+		}
+		std::string image = (args.size() > 1) ? args[1] : "";
+		bool passed = true;
+		std::string results = Benchmark::Render(frames, admin->screen->width, admin->screen->height, image, &passed);
+		std::ofstream file("bench_render.json");
+		file << results;
+		if(!passed) { return "[c:red]render benchmark written to bench_render.json, but its frame doesnt match the golden frame[c]"; }
+		return "render benchmark written to bench_render.json";
+	}, "bench_render", "bench_render [frames] [imagePath]\nrenders the headless benchmark scene and writes the stage timings to bench_render.json\nthe last frame is saved to imagePath as .ppm or .png if given");
+
+	admin->commands["bench_backface"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		uint32 iterations = 100;
+		if (args.size() > 0 && std::regex_match(args[0], std::regex("[0-9]+"))) {
+			iterations = std::stoi(args[0]);
+		}
+		std::string results = Benchmark::BackFace(iterations);
+		std::ofstream file("bench_backface.json");
+		file << results;
+		return "back-face benchmark written to bench_backface.json";
+	}, "bench_backface", "bench_backface [iterations]\ntimes the old and cached back-face tests on a dense mesh and writes them to bench_backface.json");
+
+	admin->commands["bench_sampler"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		uint32 passes = 20;
+		if (args.size() > 0 && std::regex_match(args[0], std::regex("[0-9]+"))) {
+			passes = std::stoi(args[0]);
+		}
+		std::string results = Benchmark::Sampler(passes);
+		std::ofstream file("bench_sampler.json");
+		file << results;
+		return "sampler benchmark written to bench_sampler.json";
+	}, "bench_sampler", "bench_sampler [passes]\nsamples a texture stored in each format and writes the samples per second to bench_sampler.json");
+}
+
 //add generic commands here
 void CommandSystem::Init() {
 	admin->commands["debug_global"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
@@ -428,6 +611,7 @@ void CommandSystem::Init() {
 	AddSpawnCommands(admin);
 	AddRenderCommands(admin);
 	AddConsoleCommands(admin);
+	AddBenchmarkCommands(admin);
 }
 
 void CommandSystem::Update() {
@@ -30,12 +30,11 @@ inline void AddSelectEntityCommand(EntityAdmin* admin) {
 			pos *= Math::LocalToWorld(admin->currentCamera->position);
 
 			//draw ray if debugging
-			RenderedEdge3D* ray = new RenderedEdge3D(pos, admin->currentCamera->position);
-			ray->e = (Entity*)1; // to make it not delete every frame
-			admin->currentScene->lines.push_back(ray);
+			RenderedEdge3D ray(pos, admin->currentCamera->position);
+			admin->currentScene->debug.Line(ray.p[0], ray.p[1]);
 			
 			for (Mesh* m : admin->currentScene->meshes) {
-				if (MeshSystem::LineIntersect(m, ray)) {
+				if (MeshSystem::LineIntersect(m, &ray)) {
 					admin->input->selectedEntity = m->entity;
 					break;
 				}
@@ -51,6 +50,11 @@ inline void AddSelectEntityCommand(EntityAdmin* admin) {
 	}, "select_entity", "select_entity <EntityID>");
 }
 
+//Vector3::operator== has a tolerance, and a mesh moved by less than it still has to move
+inline bool SameVector(const Vector3& a, const Vector3& b) {
+	return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
 void MeshSystem::Init() {
 	AddSelectEntityCommand(admin);
 }
@@ -68,10 +72,13 @@ void MeshSystem::Update() {
 				t = transform;
 			}
 		}
-		if(m && t) {
+		//the triangles only need moving again when the transform has
+		if(m && t && (!m->transformApplied || !SameVector(t->position, m->appliedPosition) || !SameVector(t->rotation, m->appliedRotation))) {
 			RotateMesh(m, Matrix4::RotationMatrix(t->rotation));
 			TranslateMesh(m, t->position);
-			
+			m->transformApplied = true;
+			m->appliedPosition = t->position;
+			m->appliedRotation = t->rotation;
 		}
 	}
 }
@@ -98,6 +105,7 @@ void MeshSystem::RotateMesh(Mesh* mesh, Matrix4 rotation) {
 			
 			t.points[i] = t.poffsets[i] * rotation;
 		}
+		t.normal = t.localNormal * rotation;
 		BUFFERLOG(0, t);
 	}
 }
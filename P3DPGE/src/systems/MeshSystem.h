@@ -22,7 +22,7 @@ struct MeshSystem : public System {
 	//function description goes here
 	static void TranslateMesh(Mesh* mesh, Vector3 translation);
 
-	//function description goes here
+	//sets the triangles' points to their poffsets and their normals to their local normals, rotated
 	static void RotateMesh(Mesh* mesh, Matrix4 rotation);
 
 	//function description goes here
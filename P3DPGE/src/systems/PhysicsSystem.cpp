@@ -2,6 +2,7 @@
 #include "../utils/PhysicsWorld.h"
 #include "../math/Math.h"
 #include "../geometry/Geometry.h"
+#include "../geometry/GJK.h"
 
 #include "../components/Transform.h"
 #include "../components/Physics.h"
@@ -18,6 +19,7 @@
 inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 //// translation ////
 	admin->commands["reset_position"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		std::lock_guard<std::mutex> lock(admin->physicsWorld->tickMutex); //direct writes have to wait for the physics thread's tick
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
 				p->acceleration = Vector3::ZERO;
@@ -29,6 +31,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 		}, "reset_position", "reset_position <EntityID> [String: xyz]");
 
 	admin->commands["reset_position_x"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		std::lock_guard<std::mutex> lock(admin->physicsWorld->tickMutex);
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
 				p->acceleration = Vector3(0, p->acceleration.y, p->acceleration.z);
@@ -40,6 +43,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 		}, "reset_position_x", "temp");
 
 	admin->commands["reset_position_y"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		std::lock_guard<std::mutex> lock(admin->physicsWorld->tickMutex);
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
 				p->acceleration = Vector3(p->acceleration.x, 0, p->acceleration.z);
@@ -51,6 +55,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 		}, "reset_position_y", "temp");
 
 	admin->commands["reset_position_z"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		std::lock_guard<std::mutex> lock(admin->physicsWorld->tickMutex);
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
 				p->acceleration = Vector3(p->acceleration.x, p->acceleration.y, 0);
@@ -62,6 +67,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 		}, "reset_position_z", "temp");
 
 	admin->commands["reset_velocity"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		std::lock_guard<std::mutex> lock(admin->physicsWorld->tickMutex);
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
 				p->acceleration = Vector3::ZERO;
@@ -74,7 +80,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 	admin->commands["translate_right"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
-				PhysicsSystem::AddInput(p, Vector3::RIGHT);
+				PhysicsSystem::QueueInput(admin, PhysicsInput(p, Vector3::RIGHT));
 			}
 		}
 		return "";
@@ -83,7 +89,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 	admin->commands["translate_left"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
-				PhysicsSystem::AddInput(p, Vector3::LEFT);
+				PhysicsSystem::QueueInput(admin, PhysicsInput(p, Vector3::LEFT));
 			}
 		}
 		return "";
@@ -92,7 +98,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 	admin->commands["translate_up"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
-				PhysicsSystem::AddInput(p, Vector3::UP);
+				PhysicsSystem::QueueInput(admin, PhysicsInput(p, Vector3::UP));
 			}
 		}
 		return "";
@@ -101,7 +107,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 	admin->commands["translate_down"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
-				PhysicsSystem::AddInput(p, Vector3::DOWN);
+				PhysicsSystem::QueueInput(admin, PhysicsInput(p, Vector3::DOWN));
 			}
 		}
 		return "";
@@ -110,7 +116,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 	admin->commands["translate_forward"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
-				PhysicsSystem::AddInput(p, Vector3::FORWARD);
+				PhysicsSystem::QueueInput(admin, PhysicsInput(p, Vector3::FORWARD));
 			}
 		}
 		return "";
@@ -119,7 +125,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 	admin->commands["translate_backward"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
-				PhysicsSystem::AddInput(p, Vector3::BACK);
+				PhysicsSystem::QueueInput(admin, PhysicsInput(p, Vector3::BACK));
 			}
 		}
 		return "";
@@ -128,6 +134,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 	//// rotation ////
 
 	admin->commands["reset_rotation"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		std::lock_guard<std::mutex> lock(admin->physicsWorld->tickMutex);
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
 				p->rotAcceleration = Vector3::ZERO;
@@ -139,6 +146,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 		}, "reset_rotation", "reset_rotation <EntityID> [String: xyz]");
 
 	admin->commands["reset_rotation_x"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		std::lock_guard<std::mutex> lock(admin->physicsWorld->tickMutex);
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
 				p->rotAcceleration = Vector3(0, p->rotAcceleration.y, p->rotAcceleration.z);
@@ -150,6 +158,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 		}, "reset_rotation_x", "temp");
 
 	admin->commands["reset_rotation_y"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		std::lock_guard<std::mutex> lock(admin->physicsWorld->tickMutex);
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
 				p->rotAcceleration = Vector3(p->rotAcceleration.x, 0, p->rotAcceleration.z);
@@ -161,6 +170,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 		}, "reset_rotation_y", "temp");
 
 	admin->commands["reset_rotation_z"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		std::lock_guard<std::mutex> lock(admin->physicsWorld->tickMutex);
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
 				p->rotAcceleration = Vector3(p->rotAcceleration.x, p->rotAcceleration.y, 0);
@@ -172,6 +182,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 		}, "reset_rotation_z", "temp");
 
 	admin->commands["reset_rotation_velocity"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		std::lock_guard<std::mutex> lock(admin->physicsWorld->tickMutex);
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
 				p->rotAcceleration = Vector3::ZERO;
@@ -184,7 +195,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 	admin->commands["rotate_+x"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
-				p->rotVelocity += Vector3(5, 0, 0);
+				PhysicsSystem::QueueInput(admin, PhysicsInput(p, Vector3::ZERO, Vector3(5, 0, 0)));
 			}
 		}
 		return "";
@@ -193,7 +204,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 	admin->commands["rotate_-x"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
-				p->rotVelocity += Vector3(-5, 0, 0);
+				PhysicsSystem::QueueInput(admin, PhysicsInput(p, Vector3::ZERO, Vector3(-5, 0, 0)));
 			}
 		}
 		return "";
@@ -202,7 +213,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 	admin->commands["rotate_+y"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
-				p->rotVelocity += Vector3(0, 5, 0);
+				PhysicsSystem::QueueInput(admin, PhysicsInput(p, Vector3::ZERO, Vector3(0, 5, 0)));
 			}
 		}
 		return "";
@@ -211,7 +222,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 	admin->commands["rotate_-y"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
-				p->rotVelocity += Vector3(0, -5, 0);
+				PhysicsSystem::QueueInput(admin, PhysicsInput(p, Vector3::ZERO, Vector3(0, -5, 0)));
 			}
 		}
 		return "";
@@ -220,7 +231,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 	admin->commands["rotate_+z"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
-				p->rotVelocity += Vector3(0, 0, 5);
+				PhysicsSystem::QueueInput(admin, PhysicsInput(p, Vector3::ZERO, Vector3(0, 0, 5)));
 			}
 		}
 		return "";
@@ -229,7 +240,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 	admin->commands["rotate_-z"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
 		if (admin->input->selectedEntity) {
 			if (Physics* p = admin->input->selectedEntity->GetComponent<Physics>()) {
-				p->rotVelocity += Vector3(0, 0, -5);
+				PhysicsSystem::QueueInput(admin, PhysicsInput(p, Vector3::ZERO, Vector3(0, 0, -5)));
 			}
 		}
 		return "";
@@ -238,6 +249,7 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 	//// other ////
 
 	admin->commands["add_force"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		std::lock_guard<std::mutex> lock(admin->physicsWorld->tickMutex);
 		if (USE_ORTHO) { //TODO(, sushi) implement ScreenToWorld for ortho projection
 			LOG("\nWarning: ScreenToWorld not yet implemented for orthographic projection. World interaction with mouse will not work.\n");
 		}
@@ -257,8 +269,17 @@ inline void AddSelectedEntityCommands(EntityAdmin* admin) {
 	}, "add_force", "add_force <EntityID> <force_vector> [constant_force?]");
 }
 
+inline void AddPhysicsWorldCommands(EntityAdmin* admin) {
+	admin->commands["phys_thread"] = new Command([](EntityAdmin* admin, std::vector<std::string> args) -> std::string {
+		admin->physicsWorld->threaded = !admin->physicsWorld->threaded;
+		if (admin->physicsWorld->threaded) return "phys_thread = true";
+		else return "phys_thread = false";
+	}, "phys_thread", "toggles running physics on its own thread at the fixed physics timestep");
+}
+
 void PhysicsSystem::Init() {
 	AddSelectedEntityCommands(admin);
+	AddPhysicsWorldCommands(admin);
 }
 
 //// Integration ////
@@ -368,12 +389,28 @@ inline void PhysicsTick(PhysicsTuple& t, PhysicsWorld* pw, Time* time) {
 
 //// Collision ////
 
-Matrix4 LocalToWorldInertiaTensor(Physics* physics, Matrix3 inertiaTensor) {
-	Matrix4 inverseTransformation = Matrix4::TransformationMatrix(physics->position, physics->rotation, Vector3::ONE).Inverse();
-	return inverseTransformation.Transpose() * inertiaTensor.To4x4() * inverseTransformation;
+//rotates the collider's cached local inverse inertia tensor into world space, skipped if the rotation hasnt changed
+//since the last refresh so contact resolution only ever needs 3x3 multiplies
+//a compound's children turn with its body, so they're refreshed with the body's rotation
+inline void UpdateWorldInertiaTensor(Collider* collider, const Vector3& rotation) {
+	if(CompoundCollider* compound = dynamic_cast<CompoundCollider*>(collider)) {
+		for(Collider* child : compound->children) { UpdateWorldInertiaTensor(child, rotation); }
+		return;
+	}
+	if(collider->isTrigger || collider->inertiaRotation == rotation) { return; }
+	Matrix3 rotationMatrix = Matrix3::RotationMatrix(rotation);
+	collider->worldInverseInertiaTensor = rotationMatrix.Transpose() * collider->inverseInertiaTensor * rotationMatrix;
+	collider->inertiaRotation = rotation;
+}
+
+//refreshes every body's tensors after they've all moved, so each collision sees this substep's rotations
+inline void UpdateWorldInertiaTensors(std::vector<PhysicsTuple>& tuples) {
+	for(auto& t : tuples) {
+		if(t.collider) { UpdateWorldInertiaTensor(t.collider, t.physics->rotation); }
+	}
 }
 
-inline void AABBAABBCollision(Physics* obj1, AABBCollider* obj1Col, Physics* obj2, AABBCollider* obj2Col) {
+inline bool AABBAABBCollision(Physics* obj1, AABBCollider* obj1Col, Physics* obj2, AABBCollider* obj2Col) {
 	//ERROR("AABB-AABB collision not implemented in PhysicsSystem.cpp");
 	std::vector<Vector3> obj1ps;
 	std::vector<Vector3> obj2ps;
@@ -515,28 +552,19 @@ inline void AABBAABBCollision(Physics* obj1, AABBCollider* obj1Col, Physics* obj
 			//}
 			
 		}
-		
-
-
-
-		
-
-
+		return true;
 	}
-
-
-	
-
+	return false;
 }
 
-inline void AABBSphereCollision(Physics* aabb, AABBCollider* aabbCol, Physics* sphere, SphereCollider* sphereCol) {
+inline bool AABBSphereCollision(Physics* aabb, AABBCollider* aabbCol, Physics* sphere, SphereCollider* sphereCol) {
 	Vector3 aabbPoint = Geometry::ClosestPointOnAABB(aabb->position, aabbCol->halfDims, sphere->position);
 	Vector3 vectorBetween = aabbPoint - sphere->position; //sphere towards aabb
 	float distanceBetween = vectorBetween.mag();
 	if(distanceBetween < sphereCol->radius) {
 		if(!aabbCol->isTrigger && !sphereCol->isTrigger) {
-			SUCCESS("collision happened");
-			aabb->entity->GetComponent<Source>()->request_play = true;
+			//reported after the tick by PhysicsSystem, this might be running on the physics thread
+			aabb->entity->admin->physicsWorld->collisions.push_back(aabb->entity);
 			//static resolution
 			if (aabbPoint == sphere->position) { 
 				//NOTE if the closest point is the same, the vector between will have no direction; this 
@@ -550,17 +578,15 @@ inline void AABBSphereCollision(Physics* aabb, AABBCollider* aabbCol, Physics* s
 			sphere->position -= vectorBetween;
 			
 			//dynamic resolution
-			Matrix4 sphereInertiaTensorInverse = LocalToWorldInertiaTensor(sphere, sphereCol->inertiaTensor).Inverse();
 			Vector3 ra = sphere->position + Geometry::ClosestPointOnSphere(sphere->position, sphereCol->radius, aabbPoint);
 			Vector3 sphereAngularVelocityChange = normal.cross(ra);
-			sphereAngularVelocityChange *= sphereInertiaTensorInverse;
+			sphereAngularVelocityChange *= sphereCol->worldInverseInertiaTensor;
 			float inverseMassA = 1.f / sphere->mass;
 			float scalar = inverseMassA + sphereAngularVelocityChange.cross(ra).dot(normal);
 
-			Matrix4 aabbInertiaTensorInverse = LocalToWorldInertiaTensor(aabb, aabbCol->inertiaTensor).Inverse();
 			Vector3 rb = aabb->position + aabbPoint;
 			Vector3 aabbAngularVelocityChange = normal.cross(rb);
-			aabbAngularVelocityChange *= aabbInertiaTensorInverse;
+			aabbAngularVelocityChange *= aabbCol->worldInverseInertiaTensor;
 			float inverseMassB = 1.f / aabb->mass; 
 			scalar += inverseMassB + aabbAngularVelocityChange.cross(rb).dot(normal);
 				
@@ -570,81 +596,446 @@ inline void AABBSphereCollision(Physics* aabb, AABBCollider* aabbCol, Physics* s
 			PhysicsSystem::AddImpulse(sphere, aabb, -impulse);
 			sphere->rotVelocity -= sphereAngularVelocityChange;
 			//aabb->entity->rotVelocity -= aabbAngularVelocityChange; //we dont do this because AABB shouldnt rotate
+			return true;
 		}
 	}
+	return false;
 }
 
-inline void AABBBoxCollision(Physics* aabb, AABBCollider* aabbCol, Physics* box, BoxCollider* boxCol) {
+inline bool AABBBoxCollision(Physics* aabb, AABBCollider* aabbCol, Physics* box, BoxCollider* boxCol) {
 	ERROR("AABB-Box collision not implemented in PhysicsSystem.cpp");
+	return false;
 }
 
-inline void SphereSphereCollision(Physics* sphere, SphereCollider* sphereCol, Physics* other, SphereCollider* otherCol) {
+inline bool SphereSphereCollision(Physics* sphere, SphereCollider* sphereCol, Physics* other, SphereCollider* otherCol) {
 	ERROR("Sphere-Sphere collision not implemented in PhysicsSystem.cpp");
+	return false;
 }
 
-inline void SphereBoxCollision(Physics* sphere, SphereCollider* sphereCol, Physics* box, BoxCollider* boxCol) {
+inline bool SphereBoxCollision(Physics* sphere, SphereCollider* sphereCol, Physics* box, BoxCollider* boxCol) {
 	ERROR("Sphere-Box collision not implemented in PhysicsSystem.cpp");
+	return false;
 }
 
-inline void BoxBoxCollision(Physics* box, BoxCollider* boxCol, Physics* other, BoxCollider* otherCol) {
+inline bool BoxBoxCollision(Physics* box, BoxCollider* boxCol, Physics* other, BoxCollider* otherCol) {
 	ERROR("Box-Box collision not implemented in PhysicsSystem.cpp");
+	return false;
+}
+
+//pushes a body out of a static surface and removes its velocity into the surface, normal is in world space
+inline void ResolveAgainstStatic(Physics* body, Vector3 normal, float depth) {
+	if(body->isStatic) { return; }
+	body->position += normal * depth;
+	float normalVelocity = body->velocity.dot(normal);
+	if(normalVelocity < 0) {
+		body->velocity -= normal * ((1.f + body->elasticity) * normalVelocity);
+	}
+}
+
+inline bool SphereMeshCollision(Physics* sphere, SphereCollider* sphereCol, Physics* mesh, MeshCollider* meshCol) {
+	if(sphereCol->isTrigger || !meshCol->Ready()) { return false; }
+	Matrix3 rotation = Matrix3::RotationMatrix(mesh->rotation);
+	Matrix3 inverseRotation = rotation.Transpose();
+	Vector3 center = (sphere->position - mesh->position) * inverseRotation;
+	Vector3 extent(sphereCol->radius, sphereCol->radius, sphereCol->radius);
+
+	bool collided = false;
+	meshCol->bvh.Query(center - extent, center + extent, [&](uint32 tri) {
+		const Vector3* v = &meshCol->vertices[tri * 3];
+		Vector3 closest = Geometry::ClosestPointOnTriangle(v[0], v[1], v[2], center);
+		Vector3 between = center - closest;
+		float distance = between.mag();
+		if(distance >= sphereCol->radius) { return; }
+
+		//if the center is on the triangle, push out along the triangle's face
+		Vector3 normal = (distance > 1e-6f) ? between / distance : (v[1] - v[0]).trueCross(v[2] - v[0]).normalized();
+		float depth = sphereCol->radius - distance;
+		ResolveAgainstStatic(sphere, normal * rotation, depth);
+		center += normal * depth;
+		collided = true;
+	});
+	return collided;
 }
 
+//box axes are given in world space, collision is done in the mesh's local space
+inline bool OrientedBoxMeshCollision(Physics* box, Vector3 halfDims, Matrix3 boxRotation, Physics* mesh, MeshCollider* meshCol) {
+	if(!meshCol->Ready()) { return false; }
+	Matrix3 rotation = Matrix3::RotationMatrix(mesh->rotation);
+	Matrix3 toLocal = boxRotation * rotation.Transpose();
+	Vector3 axes[3] = { Vector3::UNITX * toLocal, Vector3::UNITY * toLocal, Vector3::UNITZ * toLocal };
+	Vector3 center = (box->position - mesh->position) * rotation.Transpose();
+
+	//local space bounds of the rotated box for the BVH query
+	Vector3 extent(
+		halfDims.x * fabs(axes[0].x) + halfDims.y * fabs(axes[1].x) + halfDims.z * fabs(axes[2].x),
+		halfDims.x * fabs(axes[0].y) + halfDims.y * fabs(axes[1].y) + halfDims.z * fabs(axes[2].y),
+		halfDims.x * fabs(axes[0].z) + halfDims.y * fabs(axes[1].z) + halfDims.z * fabs(axes[2].z));
+
+	bool collided = false;
+	meshCol->bvh.Query(center - extent, center + extent, [&](uint32 tri) {
+		const Vector3* v = &meshCol->vertices[tri * 3];
+		Vector3 normal;
+		float depth;
+		if(!Geometry::TriangleBoxPenetration(v[0], v[1], v[2], center, axes, halfDims, normal, depth)) { return; }
+		ResolveAgainstStatic(box, normal * rotation, depth);
+		center += normal * depth;
+		collided = true;
+	});
+	return collided;
+}
+
+inline bool AABBMeshCollision(Physics* aabb, AABBCollider* aabbCol, Physics* mesh, MeshCollider* meshCol) {
+	if(aabbCol->isTrigger) { return false; }
+	return OrientedBoxMeshCollision(aabb, aabbCol->halfDims, Matrix3::IDENTITY, mesh, meshCol);
+}
+
+inline bool BoxMeshCollision(Physics* box, BoxCollider* boxCol, Physics* mesh, MeshCollider* meshCol) {
+	if(boxCol->isTrigger) { return false; }
+	return OrientedBoxMeshCollision(box, boxCol->halfDims, Matrix3::RotationMatrix(box->rotation), mesh, meshCol);
+}
+
+//pushes two bodies apart along normal, which points from a towards b, and removes their closing velocity along it
+//a static body doesnt move, so the other takes the whole correction
+inline void ResolveContact(Physics* a, Physics* b, Vector3 normal, float depth) {
+	if(a->isStatic && b->isStatic) { return; }
+	if(a->isStatic) { ResolveAgainstStatic(b, normal, depth); return; }
+	if(b->isStatic) { ResolveAgainstStatic(a, -normal, depth); return; }
+
+	float inverseMassA = 1.f / a->mass;
+	float inverseMassB = 1.f / b->mass;
+	float inverseMassSum = inverseMassA + inverseMassB;
+	a->position -= normal * (depth * inverseMassA / inverseMassSum);
+	b->position += normal * (depth * inverseMassB / inverseMassSum);
+
+	float closingVelocity = (b->velocity - a->velocity).dot(normal);
+	if(closingVelocity < 0) {
+		float impulse = -(1.f + fminf(a->elasticity, b->elasticity)) * closingVelocity / inverseMassSum;
+		a->velocity -= normal * (impulse * inverseMassA);
+		b->velocity += normal * (impulse * inverseMassB);
+	}
+}
+
+//GJK to find the overlap then EPA for the contact, shapes are GJK support shapes in world space
+template<class A, class B>
+inline bool GJKCollision(Physics* a, const A& shapeA, Physics* b, const B& shapeB) {
+	Vector3 simplex[4];
+	if(!GJK::Intersect(shapeA, shapeB, simplex, b->position - a->position)) { return false; }
+	Vector3 normal;
+	float depth;
+	GJK::Penetration(shapeA, shapeB, simplex, normal, depth);
+	ResolveContact(a, b, normal, depth);
+	return true;
+}
+
+inline GJK::Hull HullShape(Physics* convex, ConvexPolyCollider* convexCol) {
+	return GJK::Hull(&convexCol->vertices, Matrix3::RotationMatrix(convex->rotation), convex->position);
+}
+
+inline bool ConvexPolyAABBCollision(Physics* convex, ConvexPolyCollider* convexCol, Physics* aabb, AABBCollider* aabbCol) {
+	if(convexCol->isTrigger || aabbCol->isTrigger) { return false; }
+	return GJKCollision(convex, HullShape(convex, convexCol), aabb, GJK::Box(aabb->position, Matrix3::IDENTITY, aabbCol->halfDims));
+}
+
+inline bool ConvexPolySphereCollision(Physics* convex, ConvexPolyCollider* convexCol, Physics* sphere, SphereCollider* sphereCol) {
+	if(convexCol->isTrigger || sphereCol->isTrigger) { return false; }
+	return GJKCollision(convex, HullShape(convex, convexCol), sphere, GJK::Sphere(sphere->position, sphereCol->radius));
+}
+
+inline bool ConvexPolyBoxCollision(Physics* convex, ConvexPolyCollider* convexCol, Physics* box, BoxCollider* boxCol) {
+	if(convexCol->isTrigger || boxCol->isTrigger) { return false; }
+	return GJKCollision(convex, HullShape(convex, convexCol), box, GJK::Box(box->position, Matrix3::RotationMatrix(box->rotation), boxCol->halfDims));
+}
+
+inline bool ConvexPolyConvexPolyCollision(Physics* convex, ConvexPolyCollider* convexCol, Physics* other, ConvexPolyCollider* otherCol) {
+	if(convexCol->isTrigger || otherCol->isTrigger) { return false; }
+	return GJKCollision(convex, HullShape(convex, convexCol), other, HullShape(other, otherCol));
+}
+
+//the hull is moved into the mesh's local space and tested against each triangle its bounds overlap in the BVH
+inline bool ConvexPolyMeshCollision(Physics* convex, ConvexPolyCollider* convexCol, Physics* mesh, MeshCollider* meshCol) {
+	if(convexCol->isTrigger || !meshCol->Ready()) { return false; }
+	Matrix3 rotation = Matrix3::RotationMatrix(mesh->rotation);
+	Matrix3 inverseRotation = rotation.Transpose();
+	GJK::Hull hull(&convexCol->vertices, Matrix3::RotationMatrix(convex->rotation) * inverseRotation, (convex->position - mesh->position) * inverseRotation);
+
+	//local space bounds of the rotated hull for the BVH query
+	Vector3 min(hull.Support(-Vector3::UNITX).x, hull.Support(-Vector3::UNITY).y, hull.Support(-Vector3::UNITZ).z);
+	Vector3 max(hull.Support( Vector3::UNITX).x, hull.Support( Vector3::UNITY).y, hull.Support( Vector3::UNITZ).z);
+
+	bool collided = false;
+	meshCol->bvh.Query(min, max, [&](uint32 tri) {
+		const Vector3* v = &meshCol->vertices[tri * 3];
+		GJK::Triangle triangle(v[0], v[1], v[2]);
+		Vector3 simplex[4];
+		if(!GJK::Intersect(hull, triangle, simplex, v[0] - hull.position)) { return; }
+		Vector3 normal;
+		float depth;
+		GJK::Penetration(hull, triangle, simplex, normal, depth);
+		ResolveAgainstStatic(convex, -normal * rotation, depth);
+		hull.position -= normal * depth;
+		collided = true;
+	});
+	return collided;
+}
+
+inline bool CompoundCollision(Physics* physics, CompoundCollider* compound, Physics* other, Collider* otherCol);
+
 //NOTE make sure you are using the right physics component, because the collision 
-//functions dont check that the provided one matches the tuple
-inline void CheckCollision(PhysicsTuple& tuple, PhysicsTuple& other) {
-	if(AABBCollider* col = dynamic_cast<AABBCollider*>(tuple.collider)) {
-		if(AABBCollider* col2 = dynamic_cast<AABBCollider*>(other.collider)) {
-			AABBAABBCollision(tuple.physics, col, other.physics, col2);
-		} else if(SphereCollider* col2 = dynamic_cast<SphereCollider*>(other.collider)) {
-			AABBSphereCollision(tuple.physics, col, other.physics, col2);
-		} else if(BoxCollider* col2 = dynamic_cast<BoxCollider*>(other.collider)) {
-			AABBBoxCollision(tuple.physics, col, other.physics, col2);
-		}
-	} else if(SphereCollider* col = dynamic_cast<SphereCollider*>(tuple.collider)) {
-		if(AABBCollider* col2 = dynamic_cast<AABBCollider*>(other.collider)) {
-			AABBSphereCollision(other.physics, col2, tuple.physics, col);
-		} else if(SphereCollider* col2 = dynamic_cast<SphereCollider*>(other.collider)) {
-			SphereSphereCollision(tuple.physics, col, other.physics, col2);
-		} else if(BoxCollider* col2 = dynamic_cast<BoxCollider*>(other.collider)) {
-			SphereBoxCollision(tuple.physics, col, other.physics, col2);
-		}
-	} else if(BoxCollider* col = dynamic_cast<BoxCollider*>(tuple.collider)) {
-		if(AABBCollider* col2 = dynamic_cast<AABBCollider*>(other.collider)) {
-			AABBBoxCollision(other.physics, col2, tuple.physics, col);
-		} else if(SphereCollider* col2 = dynamic_cast<SphereCollider*>(other.collider)) {
-			SphereBoxCollision(other.physics, col2, tuple.physics, col);
-		} else if(BoxCollider* col2 = dynamic_cast<BoxCollider*>(other.collider)) {
-			BoxBoxCollision(tuple.physics, col, other.physics, col2);
+//functions dont check that the provided one matches the collider
+//returns true if a contact was resolved between the two
+inline bool CheckCollision(Physics* physics, Collider* collider, Physics* otherPhysics, Collider* otherCollider) {
+	if(CompoundCollider* col = dynamic_cast<CompoundCollider*>(collider)) {
+		return CompoundCollision(physics, col, otherPhysics, otherCollider);
+	} else if(CompoundCollider* col2 = dynamic_cast<CompoundCollider*>(otherCollider)) {
+		return CompoundCollision(otherPhysics, col2, physics, collider);
+	}
+
+	if(AABBCollider* col = dynamic_cast<AABBCollider*>(collider)) {
+		if(AABBCollider* col2 = dynamic_cast<AABBCollider*>(otherCollider)) {
+			return AABBAABBCollision(physics, col, otherPhysics, col2);
+		} else if(SphereCollider* col2 = dynamic_cast<SphereCollider*>(otherCollider)) {
+			return AABBSphereCollision(physics, col, otherPhysics, col2);
+		} else if(BoxCollider* col2 = dynamic_cast<BoxCollider*>(otherCollider)) {
+			return AABBBoxCollision(physics, col, otherPhysics, col2);
+		} else if(MeshCollider* col2 = dynamic_cast<MeshCollider*>(otherCollider)) {
+			return AABBMeshCollision(physics, col, otherPhysics, col2);
+		} else if(ConvexPolyCollider* col2 = dynamic_cast<ConvexPolyCollider*>(otherCollider)) {
+			return ConvexPolyAABBCollision(otherPhysics, col2, physics, col);
 		}
+	} else if(SphereCollider* col = dynamic_cast<SphereCollider*>(collider)) {
+		if(AABBCollider* col2 = dynamic_cast<AABBCollider*>(otherCollider)) {
+			return AABBSphereCollision(otherPhysics, col2, physics, col);
+		} else if(SphereCollider* col2 = dynamic_cast<SphereCollider*>(otherCollider)) {
+			return SphereSphereCollision(physics, col, otherPhysics, col2);
+		} else if(BoxCollider* col2 = dynamic_cast<BoxCollider*>(otherCollider)) {
+			return SphereBoxCollision(physics, col, otherPhysics, col2);
+		} else if(MeshCollider* col2 = dynamic_cast<MeshCollider*>(otherCollider)) {
+			return SphereMeshCollision(physics, col, otherPhysics, col2);
+		} else if(ConvexPolyCollider* col2 = dynamic_cast<ConvexPolyCollider*>(otherCollider)) {
+			return ConvexPolySphereCollision(otherPhysics, col2, physics, col);
+		}
+	} else if(BoxCollider* col = dynamic_cast<BoxCollider*>(collider)) {
+		if(AABBCollider* col2 = dynamic_cast<AABBCollider*>(otherCollider)) {
+			return AABBBoxCollision(otherPhysics, col2, physics, col);
+		} else if(SphereCollider* col2 = dynamic_cast<SphereCollider*>(otherCollider)) {
+			return SphereBoxCollision(otherPhysics, col2, physics, col);
+		} else if(BoxCollider* col2 = dynamic_cast<BoxCollider*>(otherCollider)) {
+			return BoxBoxCollision(physics, col, otherPhysics, col2);
+		} else if(MeshCollider* col2 = dynamic_cast<MeshCollider*>(otherCollider)) {
+			return BoxMeshCollision(physics, col, otherPhysics, col2);
+		} else if(ConvexPolyCollider* col2 = dynamic_cast<ConvexPolyCollider*>(otherCollider)) {
+			return ConvexPolyBoxCollision(otherPhysics, col2, physics, col);
+		}
+	} else if(MeshCollider* col = dynamic_cast<MeshCollider*>(collider)) {
+		if(AABBCollider* col2 = dynamic_cast<AABBCollider*>(otherCollider)) {
+			return AABBMeshCollision(otherPhysics, col2, physics, col);
+		} else if(SphereCollider* col2 = dynamic_cast<SphereCollider*>(otherCollider)) {
+			return SphereMeshCollision(otherPhysics, col2, physics, col);
+		} else if(BoxCollider* col2 = dynamic_cast<BoxCollider*>(otherCollider)) {
+			return BoxMeshCollision(otherPhysics, col2, physics, col);
+		} else if(ConvexPolyCollider* col2 = dynamic_cast<ConvexPolyCollider*>(otherCollider)) {
+			return ConvexPolyMeshCollision(otherPhysics, col2, physics, col);
+		}
+		//mesh-mesh is not supported, meshes are static
+	} else if(ConvexPolyCollider* col = dynamic_cast<ConvexPolyCollider*>(collider)) {
+		if(AABBCollider* col2 = dynamic_cast<AABBCollider*>(otherCollider)) {
+			return ConvexPolyAABBCollision(physics, col, otherPhysics, col2);
+		} else if(SphereCollider* col2 = dynamic_cast<SphereCollider*>(otherCollider)) {
+			return ConvexPolySphereCollision(physics, col, otherPhysics, col2);
+		} else if(BoxCollider* col2 = dynamic_cast<BoxCollider*>(otherCollider)) {
+			return ConvexPolyBoxCollision(physics, col, otherPhysics, col2);
+		} else if(MeshCollider* col2 = dynamic_cast<MeshCollider*>(otherCollider)) {
+			return ConvexPolyMeshCollision(physics, col, otherPhysics, col2);
+		} else if(ConvexPolyCollider* col2 = dynamic_cast<ConvexPolyCollider*>(otherCollider)) {
+			return ConvexPolyConvexPolyCollision(physics, col, otherPhysics, col2);
+		}
+	}
+	return false;
+}
+
+//runs each child against the other collider with the compound's own body moved to the child's offset,
+//so whatever pushes, bounces or forces the child get land on the body, then moves it back
+inline bool CompoundCollision(Physics* physics, CompoundCollider* compound, Physics* other, Collider* otherCol) {
+	bool collided = false;
+	Matrix3 rotation = Matrix3::RotationMatrix(physics->rotation);
+	for(size_t i = 0; i < compound->children.size(); ++i) {
+		Vector3 offset = compound->offsets[i] * rotation;
+		physics->position += offset;
+		if(CheckCollision(physics, compound->children[i], other, otherCol)) { collided = true; }
+		physics->position -= offset;
 	}
+	return collided;
 }
 
-inline void CollisionTick(std::vector<PhysicsTuple>& tuples, PhysicsTuple& t){
+inline void CollisionTick(std::vector<PhysicsTuple>& tuples, PhysicsTuple& t, PhysicsWorld* pw){
 	if(t.collider) {
 		for(auto& tuple : tuples) {
 			if(&t != &tuple && tuple.collider && t.collider->collisionLayer == tuple.collider->collisionLayer) {
-				CheckCollision(t, tuple);
+				++pw->pairsTested;
+				if(CheckCollision(t.physics, t.collider, tuple.physics, tuple.collider)) { ++pw->contactsResolved; }
 			}
 		}
 	}
 }
 
+//logs the collision and plays the entity's sound, only ever called on the main thread
+inline void CollisionHappened(Entity* entity) {
+	SUCCESS("collision happened");
+	//not every collider has a sound attached (eg. benchmark scenes), so dont assert on it
+	for(Component* c : entity->components) {
+		if(Source* source = dynamic_cast<Source*>(c)) { source->request_play = true; break; }
+	}
+}
+
+inline void ApplyInput(PhysicsInput& input) {
+	PhysicsSystem::AddInput(input.target, input.input);
+	input.target->rotVelocity += input.rotVelocity;
+}
+
+void PhysicsSystem::QueueInput(EntityAdmin* admin, PhysicsInput input) {
+	PhysicsSystem* system = admin->GetSystem<PhysicsSystem>();
+	if(system->threadRunning) {
+		input.generation = admin->physicsWorld->generation;
+		if(!system->inputQueue.Push(input)) { ERROR("physics input queue is full, dropping input"); }
+	} else {
+		ApplyInput(input);
+	}
+}
+
+//// Threading ////
+
+void PhysicsSystem::StartThread() {
+	threadRunning = true;
+	thread = std::thread(&PhysicsSystem::ThreadLoop, this);
+}
+
+void PhysicsSystem::StopThread() {
+	threadRunning = false;
+	if(thread.joinable()) { thread.join(); }
+
+	//anything queued after the last tick is applied here, unless its entity might be gone
+	PhysicsInput input;
+	while(inputQueue.Pop(input)) {
+		if(input.generation == admin->physicsWorld->generation) { ApplyInput(input); }
+	}
+	CollisionEvent event;
+	while(collisionQueue.Pop(event)) {
+		if(event.generation == admin->physicsWorld->generation) { CollisionHappened(event.entity); }
+	}
+	admin->physicsWorld->collisions.clear();
+	admin->time->physicsAccumulator = 0.f;
+}
+
+//ticks at the fixed physics timestep until StopThread(), publishing each tick's body states
+//the main thread only takes tickMutex when it changes entities or writes physics state directly
+void PhysicsSystem::ThreadLoop() {
+	PhysicsWorld* pw = admin->physicsWorld;
+	Time* time = admin->time; //only physicsDeltaTime is read, the main thread owns the rest
+	float totalTime = time->physicsTotalTime; //published in the snapshots for the main thread to copy back
+	steady_clock::duration step = duration_cast<steady_clock::duration>(duration<float>(time->physicsDeltaTime));
+	steady_clock::time_point next = steady_clock::now();
+
+	std::vector<PhysicsTuple> tuples;
+	uint32 generation = pw->generation - 1; //forces a rebuild on the first tick
+
+	while(threadRunning) {
+		next += step;
+		std::this_thread::sleep_until(next);
+
+		//dont try to catch up on ticks missed while paused or stalled
+		steady_clock::time_point now = steady_clock::now();
+		if(now - next > step * 5) { next = now; }
+		if(pw->paused) { continue; }
+
+		std::lock_guard<std::mutex> lock(pw->tickMutex);
+		if(generation != pw->generation) {
+			tuples = GetPhysicsTuples(admin);
+			generation = pw->generation;
+		}
+
+		PhysicsInput input;
+		while(inputQueue.Pop(input)) {
+			if(input.generation == generation) { ApplyInput(input); }
+		}
+
+		PhysicsSnapshot& snapshot = snapshots.Back();
+		snapshot.bodies.resize(tuples.size());
+		for(size_t i = 0; i < tuples.size(); ++i) {
+			snapshot.bodies[i].transform = tuples[i].transform;
+			snapshot.bodies[i].prevPosition = tuples[i].physics->position;
+			snapshot.bodies[i].prevRotation = tuples[i].physics->rotation;
+		}
+
+		for(auto& t : tuples) { PhysicsTick(t, pw, time); }
+		UpdateWorldInertiaTensors(tuples);
+		for(auto& t : tuples) { CollisionTick(tuples, t, pw); }
+		totalTime += time->physicsDeltaTime;
+
+		//a full queue drops the event, which only loses a log line or a sound
+		for(Entity* e : pw->collisions) { collisionQueue.Push(CollisionEvent{e, generation}); }
+		pw->collisions.clear();
+
+		for(size_t i = 0; i < tuples.size(); ++i) {
+			snapshot.bodies[i].position = tuples[i].physics->position;
+			snapshot.bodies[i].rotation = tuples[i].physics->rotation;
+			snapshot.bodies[i].velocity = tuples[i].physics->velocity;
+			snapshot.bodies[i].acceleration = tuples[i].physics->acceleration;
+		}
+		snapshot.generation = generation;
+		snapshot.time = steady_clock::now();
+		snapshot.totalTime = totalTime;
+		snapshots.Publish();
+	}
+}
+
+PhysicsSystem::~PhysicsSystem() {
+	if(threadRunning) { StopThread(); }
+}
+
 void PhysicsSystem::Update() {
 	Time* time = admin->time;
 	PhysicsWorld* pw = admin->physicsWorld;
+
+	if(pw->threaded != threadRunning) {
+		if(pw->threaded) { StartThread(); }
+		else { StopThread(); }
+	}
+
+	//interpolate between the last two ticks the physics thread published by the time since the newest one
+	if(threadRunning) {
+		CollisionEvent event;
+		while(collisionQueue.Pop(event)) {
+			if(event.generation == pw->generation) { CollisionHappened(event.entity); }
+		}
+
+		snapshots.Update();
+		PhysicsSnapshot& snapshot = snapshots.Front();
+		time->physicsTotalTime = std::max(time->physicsTotalTime, snapshot.totalTime);
+		if(snapshot.generation != pw->generation) { return; } //entities changed since, the transform pointers might be stale
+
+		float alpha = duration<float>(steady_clock::now() - snapshot.time).count() / time->physicsDeltaTime;
+		alpha = std::min(std::max(alpha, 0.f), 1.f);
+		for(BodyState& b : snapshot.bodies) {
+			b.transform->prevPosition = b.transform->position;
+			b.transform->prevRotation = b.transform->rotation;
+			b.transform->position = b.prevPosition * (1.f - alpha) + b.position * alpha;
+			b.transform->rotation = b.prevRotation * (1.f - alpha) + b.rotation * alpha;
+		}
+		return;
+	}
 	
 	std::vector<PhysicsTuple> tuples = GetPhysicsTuples(admin);
 
 	//update physics extra times per frame if frame time delta is larger than physics time delta
 	while(time->physicsAccumulator >= time->physicsDeltaTime) {
-		for(auto& t : tuples) {
-			PhysicsTick(t, pw, time);
-			CollisionTick(tuples, t);
-		}
+		for(auto& t : tuples) { PhysicsTick(t, pw, time); }
+		UpdateWorldInertiaTensors(tuples);
+		for(auto& t : tuples) { CollisionTick(tuples, t, pw); }
 		time->physicsAccumulator -= time->physicsDeltaTime;
 		time->physicsTotalTime += time->physicsDeltaTime;
 	}
+	for(Entity* e : pw->collisions) { CollisionHappened(e); }
+	pw->collisions.clear();
 
 	//interpolate between new physics position and old transform position by the leftover time
 	float alpha = time->physicsAccumulator / time->physicsDeltaTime;
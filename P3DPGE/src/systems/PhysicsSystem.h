@@ -1,15 +1,73 @@
 #pragma once
 #include "System.h"
+#include "../math/Vector3.h"
+#include "../utils/Concurrency.h"
+
+#include <thread>
 
-struct Vector3;
 struct Physics;
+struct Transform;
+
+//a body's last two ticked states, published by the physics thread for the main thread to interpolate
+struct BodyState {
+	Transform* transform;
+	Vector3 prevPosition;
+	Vector3 prevRotation;
+	Vector3 position;
+	Vector3 rotation;
+	Vector3 velocity;		//for drawing the physics vectors, the main thread cant read Physics while the thread ticks it
+	Vector3 acceleration;
+};
+
+struct PhysicsSnapshot {
+	std::vector<BodyState> bodies;
+	uint32 generation = 0; //PhysicsWorld::generation the bodies were gathered at
+	steady_clock::time_point time;
+	float totalTime = 0; //Time::physicsTotalTime after the tick
+};
+
+//input to a body from outside the physics tick, eg. the translate and rotate commands
+struct PhysicsInput {
+	Physics* target;
+	Vector3 input;
+	Vector3 rotVelocity;
+	uint32 generation = 0;
+
+	PhysicsInput(Physics* target = nullptr, Vector3 input = Vector3::ZERO, Vector3 rotVelocity = Vector3::ZERO) {
+		this->target = target;
+		this->input = input;
+		this->rotVelocity = rotVelocity;
+	}
+};
+
+//a collision the main thread reacts to, logging and playing sounds arent safe from the physics thread
+struct CollisionEvent {
+	Entity* entity = nullptr;
+	uint32 generation = 0; //PhysicsWorld::generation when it happened, the entity might be gone if it changed since
+};
 
 struct PhysicsSystem : public System {
+	//threaded mode, toggled with PhysicsWorld::threaded
+	std::thread thread;
+	std::atomic<bool> threadRunning{false};
+	TripleBuffer<PhysicsSnapshot> snapshots;
+	SPSCQueue<PhysicsInput, 256> inputQueue;
+	SPSCQueue<CollisionEvent, 256> collisionQueue;
+
 	static inline void AddForce(Physics* creator, Physics* target, Vector3 force);
 	static inline void AddInput(Physics* target, Vector3 input);
 	static inline void AddFrictionForce(Physics* creator, Physics* target, float frictionCoef, float gravity = 9.81f);
 	static inline void AddImpulse(Physics* creator, Physics* target, Vector3 impulse, bool ignoreMass = false);
 
+	//applies input to a body right away, or hands it to the physics thread when its running
+	static void QueueInput(EntityAdmin* admin, PhysicsInput input);
+
 	void Init() override;
 	void Update() override;
-};
\ No newline at end of file
+
+	void StartThread();
+	void StopThread();
+	void ThreadLoop();
+
+	~PhysicsSystem();
+};
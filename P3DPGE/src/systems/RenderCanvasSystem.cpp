@@ -1,5 +1,6 @@
 #include "RenderCanvasSystem.h"
 #include "ConsoleSystem.h"
+#include "RenderSceneSystem.h"
 #include "../utils/GLOBALS.h"
 #include "../ui/UI.h"
 #include "../ui/UIContainer.h"
@@ -51,6 +52,7 @@ void MakeMenuBar(EntityAdmin* admin) {
 			static bool pause_engine = false;
 			if(MenuItem("pause engine", 0, &pause_engine)) { pause_engine = !pause_engine; admin->ExecCommand("time_pause_engine"); }
 			if(MenuItem("next frame")) { admin->ExecCommand("time_next_frame"); }
+			MenuItem("render stats", 0, &admin->tempCanvas->SHOW_RENDER_STATS);
 			ImGui::EndMenu();
 		}
 		if(BeginMenu("Spawn")) {
@@ -147,6 +149,7 @@ void MakeRenderHeader(EntityAdmin* admin) {
 			TableNextColumn(); Checkbox("mesh normals", &scene->RENDER_MESH_NORMALS);
 			TableNextColumn(); Checkbox("grid", &scene->RENDER_GRID);
 			TableNextColumn(); Checkbox("light rays", &scene->RENDER_LIGHT_RAYS);
+			TableNextColumn(); Checkbox("dynamic resolution", &scene->DYNAMIC_RESOLUTION);
 			EndTable();
 		}
 	}
@@ -231,6 +234,58 @@ void DrawFrameGraph(EntityAdmin* admin) { //TODO(r, sushi) implement styling and
 	ImGui::End();
 }
 
+//each render stage's time in the last frame next to what it let through, with a graph of the frame's total
+void DrawRenderStats(EntityAdmin* admin) {
+	using namespace ImGui;
+	RenderSceneSystem* render = admin->GetSystem<RenderSceneSystem>();
+	const RenderTimings& t = render->timings;
+	const RenderCounters& c = render->counters;
+
+	ImGui::Begin("Render Stats", 0, ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_AlwaysAutoResize);
+
+	//shade overlaps raster and occlusion overlaps vertex, so theyre left out of the total
+	float total = t.gather + t.cull + t.shadow + t.vertex + t.setup + t.bin + t.raster + t.present + t.lines + t.ui;
+	static std::vector<float> totals(120);
+	std::rotate(totals.begin(), totals.begin() + 1, totals.end());
+	totals[totals.size() - 1] = total;
+	Text("Total: %.3f ms", total);
+	if(c.reused) {
+		Text("Reused: nothing changed, the last frame was shown again");
+	}
+	if(admin->currentScene->DYNAMIC_RESOLUTION) {
+		Text("Resolution: %.0f%% of the screen, raster target %.2f ms", 100.f * render->resolution.scale, render->resolution.targetMS);
+	}
+	PlotLines("##renderTotal", &totals[0], totals.size(), 0, 0, 0, FLT_MAX, ImVec2(300, 60));
+
+	if(BeginTable("renderStats", 3, ImGuiTableFlags_BordersOuter | ImGuiTableFlags_RowBg)) {
+		TableSetupColumn("Stage", ImGuiTableColumnFlags_WidthFixed);
+		TableSetupColumn("ms", ImGuiTableColumnFlags_WidthFixed);
+		TableSetupColumn("Counts");
+		TableHeadersRow();
+		auto row = [](const char* stage, double ms, const std::string& counts) {
+			TableNextRow();
+			TableNextColumn(); TextUnformatted(stage);
+			TableNextColumn(); Text("%.3f", ms);
+			TableNextColumn(); TextUnformatted(counts.c_str());
+		};
+		row("gather", t.gather, TOSTRING(c.meshes, " meshes, ", c.trianglesTotal, " tris"));
+		row("cull", t.cull, TOSTRING(c.meshesCulled, " meshes, ", c.trianglesCulled, " tris culled, ", c.trianglesSubmitted, " submitted"));
+		row("shadow", t.shadow, "");
+		row("vertex", t.vertex, "");
+		row("occlusion", t.occlusion, TOSTRING(c.meshesOccluded, " meshes, ", c.trianglesOccluded, " tris occluded"));
+		row("setup", t.setup, TOSTRING(c.trianglesBackFacing, " back-facing, ", c.trianglesClipped, " clipped, ", c.trianglesOffscreen, " offscreen"));
+		row("bin", t.bin, TOSTRING(c.trianglesRasterized, " tris rasterized"));
+		row("raster", t.raster, TOSTRING(c.pixelsWritten, " px written, ", c.pixelsCovered, " covered, ", c.pixelsHizRejected, " hi-z rejected"));
+		row("shade", t.shade, TOSTRING(c.pixelsShaded, " px shaded"));
+		row("present", t.present, "");
+		row("lines", t.lines, TOSTRING(c.linesDrawn, " drawn"));
+		row("ui", t.ui, "");
+		EndTable();
+	}
+
+	ImGui::End();
+}
+
 void RenderCanvasSystem::DrawUI(void) {
 	using namespace ImGui;
 	//These 3 lines are mandatory per-frame initialization
@@ -265,6 +320,7 @@ void RenderCanvasSystem::DrawUI(void) {
 	}
 		
 	if (admin->tempCanvas->SHOW_FPS_GRAPH) DrawFrameGraph(admin);
+	if (admin->tempCanvas->SHOW_RENDER_STATS) DrawRenderStats(admin);
 
 	////////////////////////////////////////////
 
@@ -1,5 +1,6 @@
 #include "RenderSceneSystem.h"
 #include "ConsoleSystem.h"
+#include "PhysicsSystem.h"
 #include "../math/Math.h"
 
 #include "../components/Scene.h"
@@ -10,389 +11,312 @@
 #include "../components/Transform.h"
 #include "../components/Physics.h"
 #include "../components/Time.h"
+#include "../utils/PhysicsWorld.h"
 
-void RenderSceneSystem::Init() {
-	
-}
-
-void TexturedTriangle(Scene* scene, Screen* screen, olc::PixelGameEngine* p, Triangle* tri){	
-	int x1 = tri->proj_points[0].x; int x2 = tri->proj_points[1].x; int x3 = tri->proj_points[2].x;
-	int y1 = tri->proj_points[0].y; int y2 = tri->proj_points[1].y; int y3 = tri->proj_points[2].y;
-		
-	float u1 = tri->proj_tex_points[0].x; float u2 = tri->proj_tex_points[1].x; float u3 = tri->proj_tex_points[2].x;
-	float v1 = tri->proj_tex_points[0].y; float v2 = tri->proj_tex_points[1].y; float v3 = tri->proj_tex_points[2].y;
-	float w1 = tri->proj_tex_points[0].z; float w2 = tri->proj_tex_points[1].z; float w3 = tri->proj_tex_points[2].z;
-
-	if (y2 < y1) { std::swap(y1, y2); std::swap(x1, x2); std::swap(u1, u2); std::swap(v1, v2); std::swap(w1, w2); }
-	if (y3 < y1) { std::swap(y1, y3); std::swap(x1, x3); std::swap(u1, u3); std::swap(v1, v3); std::swap(w1, w3); }
-	if (y3 < y2) { std::swap(y2, y3); std::swap(x2, x3); std::swap(u2, u3); std::swap(v2, v3); std::swap(w2, w3); }
-
-	int dy1 = y2 - y1;
-	int dx1 = x2 - x1;
-	float dv1 = v2 - v1;
-	float du1 = u2 - u1;
-	float dw1 = w2 - w1;
-
-	int dy2 = y3 - y1;
-	int dx2 = x3 - x1;
-	float dv2 = v3 - v1;
-	float du2 = u3 - u1;
-	float dw2 = w3 - w1;
-
-	float tex_u, tex_v, tex_w;
-
-	float	dax_step = 0, dbx_step = 0,
-			du1_step = 0, dv1_step = 0,
-			du2_step = 0, dv2_step = 0,
-			dw1_step = 0, dw2_step = 0;
-
-	if (dy1) dax_step = dx1 / (float)abs(dy1);
-	if (dy2) dbx_step = dx2 / (float)abs(dy2);
-
-	if (dy1) du1_step = du1 / (float)abs(dy1);
-	if (dy1) dv1_step = dv1 / (float)abs(dy1);
-	if (dy1) dw1_step = dw1 / (float)abs(dy1);
-
-	if (dy2) du2_step = du2 / (float)abs(dy2);
-	if (dy2) dv2_step = dv2 / (float)abs(dy2);
-	if (dy2) dw2_step = dw2 / (float)abs(dy2);
-
-	if (dy1) {
-		for (int i = y1; i <= y2; i++) {
-			int ax = x1 + (float)(i - y1) * dax_step;
-			int bx = x1 + (float)(i - y1) * dbx_step;
-
-			float tex_su = u1 + (float)(i - y1) * du1_step;
-			float tex_sv = v1 + (float)(i - y1) * dv1_step;
-			float tex_sw = w1 + (float)(i - y1) * dw1_step;
-
-			float tex_eu = u1 + (float)(i - y1) * du2_step;
-			float tex_ev = v1 + (float)(i - y1) * dv2_step;
-			float tex_ew = w1 + (float)(i - y1) * dw2_step;
-
-			if (ax > bx) {
-				std::swap(ax, bx);
-				std::swap(tex_su, tex_eu);
-				std::swap(tex_sv, tex_ev);
-				std::swap(tex_sw, tex_ew);
-			}
-
-			tex_u = tex_su;
-			tex_v = tex_sv;
-			tex_w = tex_sw;
+#include "../render/Clipper.h"
+#include "../geometry/Frustum.h"
 
-			float tstep = 1.0f / ((float)(bx - ax));
-			float t = 0.0f;
+#include <cstring>
 
-			for (int j = ax; j < bx; j++) {
-				tex_u = (1.0f - t) * tex_su + t * tex_eu;
-				tex_v = (1.0f - t) * tex_sv + t * tex_ev; 
-				tex_w = (1.0f - t) * tex_sw + t * tex_ew; 
-
-				//LOG(tex_w);
+void RenderSceneSystem::Init() {
+	//kept between frames so its shadow map can be too
+	defaultLight = new Light(Vector3(0, 1.5, 1), Vector3(0, 0, 1));
+}
 
-				if (tex_w > scene->pixelDepthBuffer[i * (size_t)screen->width + j]) {
-					p->Draw(j, i, tri->e->GetComponent<Mesh>()->texture->Sample(tex_u / tex_w, tex_v / tex_w));
-					scene->pixelDepthBuffer[i * (size_t)screen->width + j] = tex_w;
-				}
-				t += tstep;
-			}
+//fills visible with the meshes whose bounds reach into the camera's frustum, tested before any of their vertices or triangles are touched
+//each mesh's local sphere is checked first since its one dot product per plane, then the box around its world space AABB
+//returns the number of meshes culled and adds their triangles to culledTriCount
+int CullMeshes(Scene* scene, Camera* camera, std::vector<MeshInstance>& visible, int& culledTriCount) {
+	visible.clear();
+	culledTriCount = 0;
+
+	//ortho projection maps z differently and its planes would cull everything, see CameraSystem
+	if(USE_ORTHO) {
+		for(Mesh* mesh : scene->meshes) {
+			visible.push_back({mesh, VertexStage::ModelMatrix(mesh), 0, mesh->occluder});
 		}
+		return 0;
 	}
 
-	dy1 = y3 - y2;
-	dx1 = x3 - x2;
-	dv1 = v3 - v2;
-	du1 = u3 - u2;
-	dw1 = w3 - w2;
+	Frustum frustum(camera->viewMatrix * camera->projectionMatrix);
+	int culledMeshCount = 0;
+	for(Mesh* mesh : scene->meshes) {
+		Matrix4 model = VertexStage::ModelMatrix(mesh);
+
+		//the model matrix is only rotation and translation, so the radius carries over unchanged
+		bool outside = frustum.SphereOutside(mesh->sphereCenter * model, mesh->sphereRadius);
+		if(!outside) {
+			//world space box around the rotated local box (arvo), its center moves with the matrix and
+			//its half extents are the local ones through the absolute value of the rotation
+			Vector3 center = ((mesh->boundsMin + mesh->boundsMax) / 2.f) * model;
+			Vector3 half = (mesh->boundsMax - mesh->boundsMin) / 2.f;
+			const float* m = model.data;
+			Vector3 extent(fabs(m[0]) * half.x + fabs(m[4]) * half.y + fabs(m[ 8]) * half.z,
+						   fabs(m[1]) * half.x + fabs(m[5]) * half.y + fabs(m[ 9]) * half.z,
+						   fabs(m[2]) * half.x + fabs(m[6]) * half.y + fabs(m[10]) * half.z);
+			outside = frustum.AABBOutside(center - extent, center + extent);
+		}
 
-	if (dy1) dax_step = dx1 / (float)abs(dy1);
-	if (dy2) dbx_step = dx2 / (float)abs(dy2);
+		if(outside) {
+			culledMeshCount++;
+			culledTriCount += mesh->triangles.size();
+		} else {
+			visible.push_back({mesh, model, 0, mesh->occluder});
+		}
+	}
+	return culledMeshCount;
+} //CullMeshes
+
+//a level of detail is drawn once its error would cover less than this many pixels
+static const float LOD_PIXEL_ERROR = 1.f;
+//and meshes only step down to a coarser level once its error is under this fraction of that,
+//so a mesh sitting right at a threshold doesnt flicker between two levels
+static const float LOD_HYSTERESIS = .5f;
+
+//picks each mesh's level of detail from how far the nearest point of its bounding sphere is from the camera,
+//the error of every level is in local units so it scales to pixels with the projection at that depth
+//the level is kept on the mesh for the hysteresis and copied to its instance
+void SelectLODs(std::vector<MeshInstance>& meshes, Camera* camera, Screen* screen, bool enabled) {
+	//pixels a unit covers at a depth of 1, the projection's y scale over half the screen
+	float focal = fabs(camera->projectionMatrix.data[5]) * .5f * screen->height;
+	for(MeshInstance& instance : meshes) {
+		Mesh* mesh = instance.mesh;
+		//ortho projection doesnt shrink with distance, see CullMeshes
+		if(!enabled || USE_ORTHO || mesh->lods.empty()) {
+			mesh->lodLevel = instance.lodLevel = 0;
+			continue;
+		}
 
-	du1_step = 0, dv1_step = 0;
-	if (dy1) du1_step = du1 / (float)abs(dy1);
-	if (dy1) dv1_step = dv1 / (float)abs(dy1);
-	if (dy1) dw1_step = dw1 / (float)abs(dy1);
+		Vector3 center = mesh->sphereCenter * (instance.model * camera->viewMatrix);
+		float depth = center.z - mesh->sphereRadius;
+		if(depth <= camera->nearZ) {
+			mesh->lodLevel = instance.lodLevel = 0;
+			continue;
+		}
+		float pixelsPerUnit = focal / depth;
 
-	if (dy1) {
-		for (int i = y2; i <= y3; i++) {
-			int ax = x2 + (float)(i - y2) * dax_step;
-			int bx = x1 + (float)(i - y1) * dbx_step;
+		uint32 level = std::min(mesh->lodLevel, (uint32)mesh->lods.size());
+		while(level > 0 && mesh->LODError(level) * pixelsPerUnit > LOD_PIXEL_ERROR) { level--; }
+		while(level < mesh->lods.size() && mesh->LODError(level + 1) * pixelsPerUnit < LOD_PIXEL_ERROR * LOD_HYSTERESIS) { level++; }
+		mesh->lodLevel = instance.lodLevel = level;
+	}
+} //SelectLODs
+
+//renders the packet light's shadow map again if its update policy says the one it has is out of date
+//returns true if it was rendered
+bool UpdateShadowMap(const RenderPacket& packet, ThreadPool* pool) {
+	ShadowMap& map = packet.light->shadowMap;
+	bool render = false;
+	switch(packet.shadowUpdate) {
+		case Light::SHADOW_UPDATE_NONE:			return false;
+		case Light::SHADOW_UPDATE_ONCE:			render = !map.valid || map.resolution != packet.shadowResolution; break;
+		case Light::SHADOW_UPDATE_ON_CHANGE:	render = map.Changed(packet.lightDirection, packet.shadowResolution, packet.casters, packet.casterModels); break;
+		case Light::SHADOW_UPDATE_EVERY_FRAME:	render = true; break;
+	}
+	if(render) {
+		map.Render(packet.lightDirection, packet.shadowResolution, packet.casters, packet.casterModels, pool);
+	}
+	return render;
+} //UpdateShadowMap
 
-			float tex_su = u2 + (float)(i - y2) * du1_step;
-			float tex_sv = v2 + (float)(i - y2) * dv1_step;
-			float tex_sw = w2 + (float)(i - y2) * dw1_step;
+//milliseconds since start, for the stage timings
+inline double ElapsedMS(steady_clock::time_point start) {
+	return duration_cast<duration<double, std::milli>>(steady_clock::now() - start).count();
+}
 
-			float tex_eu = u1 + (float)(i - y1) * du2_step;
-			float tex_ev = v1 + (float)(i - y1) * dv2_step;
-			float tex_ew = w1 + (float)(i - y1) * dw2_step;
+//renders the packet's meshes into the framebuffer without touching the PixelGameEngine or the entities, so it runs
+//headless and off the main thread too
+//meshes hidden behind occluders are skipped when occlusion is given, and pixels are shadowed when shadow is
+//the packet's screenBoxes gets each mesh's screen rect when it asks for bounding boxes
+//counters gets what each stage rejected and how many triangles were queued
+void RenderTriangles(RenderPacket& packet, Framebuffer* framebuffer, Rasterizer* rasterizer, VertexStage* vertexStage,
+					 OcclusionBuffer* occlusion, const ShadowMap* shadow, ThreadPool* pool, RenderTimings* timings, RenderCounters* counters) {
+	const std::vector<MeshInstance>& meshes = packet.meshes;
+	Camera* camera = &packet.camera;
+	Screen* screen = &packet.renderScreen;
+	packet.screenBoxes.clear();
+	rasterizer->Begin(screen->width, screen->height);
+	GuardBand guard(screen->width, screen->height);
+
+	//transform every unique vertex once, triangles below only index into the results
+	//the occluders are drawn at the same time since they only need the meshes and the camera
+	steady_clock::time_point start = steady_clock::now();
+	timings->occlusion = 0;
+	pool->ParallelFor(2, [&](uint32 job) {
+		if(job == 0) {
+			vertexStage->Run(pool, meshes, camera, screen);
+		} else if(occlusion) {
+			steady_clock::time_point occlusionStart = steady_clock::now();
+			occlusion->Render(meshes, camera, screen);
+			timings->occlusion = ElapsedMS(occlusionStart);
+		}
+	});
+	timings->vertex = ElapsedMS(start);
+	start = steady_clock::now();
+
+	for(uint32 meshIndex = 0; meshIndex < meshes.size(); ++meshIndex) {
+		const MeshInstance& instance = meshes[meshIndex];
+		Mesh* mesh = instance.mesh;
+		//occluders never hide themselves, so they're never tested
+		if(occlusion && !instance.occluder && occlusion->Occluded(mesh, vertexStage->modelViews[meshIndex], camera)) {
+			occlusion->occludedMeshes++;
+			uint32 lodTriangles = (uint32)mesh->LODIndices(instance.lodLevel).size() / 3;
+			occlusion->occludedTriangles += lodTriangles;
+			counters->meshesOccluded++;
+			counters->trianglesOccluded += lodTriangles;
+			continue;
+		}
 
-			if (ax > bx) {
-				std::swap(ax, bx);
-				std::swap(tex_su, tex_eu);
-				std::swap(tex_sv, tex_ev);
-				std::swap(tex_sw, tex_ew);
+		const ProjectedVertex* meshVertices = vertexStage->vertices.data() + vertexStage->meshOffsets[meshIndex];
+		Vector2 screenMin( INFINITY,  INFINITY);
+		Vector2 screenMax(-INFINITY, -INFINITY);
+		const std::vector<Vector3>& localVertices = mesh->LODVertices(instance.lodLevel);
+		const std::vector<uint32>& meshIndices = mesh->LODIndices(instance.lodLevel);
+		Matrix4 toShadow = shadow ? instance.model * shadow->lightMatrix : Matrix4::IDENTITY;
+		const std::vector<FacePlane>& planes = mesh->LODFacePlanes(instance.lodLevel);
+		Vector3 eye = VertexStage::LocalEye(vertexStage->modelViews[meshIndex]);
+		uint32 meshTriCount = (uint32)meshIndices.size() / 3;
+		for(uint32 triIndex = 0; triIndex < meshTriCount; ++triIndex) {
+			//the triangle faces the camera when the camera is in front of its plane
+			const FacePlane& plane = planes[triIndex];
+			if(plane.normal.dot(eye) <= plane.offset) {
+				counters->trianglesBackFacing++;
+				continue;
 			}
 
-			tex_u = tex_su;
-			tex_v = tex_sv;
-			tex_w = tex_sw;
+			Vector3 uvs[3];
+			olc::Pixel color;
+			mesh->LODAttributes(instance.lodLevel, triIndex, uvs, color);
+			const ProjectedVertex* v[3] = {
+				&meshVertices[meshIndices[3 * triIndex + 0]],
+				&meshVertices[meshIndices[3 * triIndex + 1]],
+				&meshVertices[meshIndices[3 * triIndex + 2]]
+			};
+
+			//clipping ping-pongs between these two, so nothing is allocated
+			ClipPolygon polygon;
+			ClipPolygon scratch;
+			ClipPolygon* clipped = &polygon;
+			bool nearClipped = false;
+			polygon.count = 3;
+			if(shadow) {
+				for(int i = 0; i < 3; ++i) { polygon.vertices[i].shadow = localVertices[meshIndices[3 * triIndex + i]] * toShadow; }
+			}
 
-			float tstep = 1.0f / ((float)(bx - ax));
-			float t = 0.0f;
+			if(v[0]->camera.z >= camera->nearZ && v[1]->camera.z >= camera->nearZ && v[2]->camera.z >= camera->nearZ) {
+		//already projected by the vertex stage
+				for(int i = 0; i < 3; ++i) {
+					polygon.vertices[i].position = v[i]->screen;
+					polygon.vertices[i].tex = Vector3(uvs[i].x * v[i]->invW, uvs[i].y * v[i]->invW, v[i]->invW);
+					polygon.vertices[i].shadow = polygon.vertices[i].shadow * v[i]->invW;
+				}
+			} else {
+		//clip to the nearZ plane in view/clip space, then project the clipped points
+				for(int i = 0; i < 3; ++i) {
+					polygon.vertices[i].position = v[i]->camera;
+					polygon.vertices[i].tex = uvs[i];
+				}
+				ClipPolygonToPlane(polygon, scratch, Vector3(0, 0, camera->nearZ), Vector3::FORWARD);
+				clipped = &scratch;
+				nearClipped = true;
+				if(clipped->count < 3) {
+					counters->trianglesClipped++;
+					continue;
+				}
 
-			for (int j = ax; j < bx; j++) {
-				tex_u = (1.0f - t) * tex_su + t * tex_eu;
-				tex_v = (1.0f - t) * tex_sv + t * tex_ev;
-				tex_w = (1.0f - t) * tex_sw + t * tex_ew;
+				for(int i = 0; i < clipped->count; ++i) {
+					ClipVertex& cv = clipped->vertices[i];
+					float w;
+					cv.position = Math::CameraToScreen(cv.position, camera->projectionMatrix, screen->dimensions, w);
+					cv.tex.x /= w;
+					cv.tex.y /= w;
+					cv.tex.z = 1.f / w;
+					cv.shadow = cv.shadow / w;
+				}
+			}
 
-				if (tex_w > scene->pixelDepthBuffer[i * (size_t)screen->width + j]) {
+			uint8 offscreen = 0xF; //sides of the screen every point is past
+			uint8 outsideGuard = 0;  //sides of the guard band any point is past
+			for(int i = 0; i < clipped->count; ++i) {
+				const Vector3& sp = clipped->vertices[i].position;
+				offscreen &= GuardBand::Outcode(sp, 0, 0, screen->width, screen->height);
+				outsideGuard |= GuardBand::Outcode(sp, guard.minX, guard.minY, guard.maxX, guard.maxY);
 
-					p->Draw(j, i, tri->e->GetComponent<Mesh>()->texture->Sample(tex_u / tex_w, tex_v / tex_w));
-					scene->pixelDepthBuffer[i * (size_t)screen->width + j] = tex_w;
+				if(packet.boundingBoxes) {
+					screenMin.x = std::min(screenMin.x, sp.x); screenMin.y = std::min(screenMin.y, sp.y);
+					screenMax.x = std::max(screenMax.x, sp.x); screenMax.y = std::max(screenMax.y, sp.y);
 				}
-				t += tstep;
+			}
+			if(offscreen) {
+				counters->trianglesOffscreen++;
+				continue;
+			}
+
+		//clip to the guard band in screen space, the rasterizer scissors anything inside it for free
+			if(outsideGuard) {
+				clipped = guard.Clip(clipped, (clipped == &polygon) ? &scratch : &polygon, outsideGuard);
+			}
+			if(nearClipped || outsideGuard) { counters->trianglesClipped++; }
+
+		//queue triangles for drawing, fanning out the clipped polygon
+			for(int i = 1; i + 1 < clipped->count; ++i) {
+				RasterTriangle rt;
+				rt.points[0] = clipped->vertices[0].position;		rt.texPoints[0] = clipped->vertices[0].tex;
+				rt.points[1] = clipped->vertices[i].position;		rt.texPoints[1] = clipped->vertices[i].tex;
+				rt.points[2] = clipped->vertices[i + 1].position;	rt.texPoints[2] = clipped->vertices[i + 1].tex;
+				rt.texture = mesh->texture;
+				rt.color = color;
+				rt.shadow = shadow;
+				rt.shadowPoints[0] = clipped->vertices[0].shadow;
+				rt.shadowPoints[1] = clipped->vertices[i].shadow;
+				rt.shadowPoints[2] = clipped->vertices[i + 1].shadow;
+				rasterizer->triangles.push_back(rt);
+				counters->trianglesRasterized++;
 			}
 		}
+		if(packet.boundingBoxes && screenMin.x <= screenMax.x) {
+			packet.screenBoxes.push_back(std::make_pair(screenMin, screenMax - screenMin));
+		}
 	}
-}
 
-int ClipTriangles(const Vector3& plane_p, Vector3 plane_n, Triangle* in_tri, std::array<Triangle*, 2>& out_tris) {
-	plane_n.normalize();
-
-	//temp storage to classify points on either side of plane
-	Vector3* inside_points[3];  int nInsidePointCount = 0;
-	Vector3* outside_points[3]; int nOutsidePointCount = 0;
-	Vector3* inside_tex[3];		int nInsideTexCount = 0;
-	Vector3* outside_tex[3];	int nOutsideTexCount = 0;
-
-	auto dist = [&](const Vector3& p)
-	{
-		return (plane_n.x * p.x + plane_n.y * p.y + plane_n.z * p.z - plane_n.dot(plane_p));
-	};
+	timings->setup = ElapsedMS(start);
 
-	//signed distance of each point in triangle to plane
-	float d0 = dist(in_tri->proj_points[0]);
-	float d1 = dist(in_tri->proj_points[1]);
-	float d2 = dist(in_tri->proj_points[2]);
+//fill triangles across the tiles in parallel into the scene's framebuffer
+	start = steady_clock::now();
+	rasterizer->Bin();
+	timings->bin = ElapsedMS(start);
 
-	if (d0 >= 0) { inside_points[nInsidePointCount++]   = &in_tri->proj_points[0]; inside_tex[nInsideTexCount++]   = &in_tri->proj_tex_points[0]; }
-	else         { outside_points[nOutsidePointCount++] = &in_tri->proj_points[0]; outside_tex[nOutsideTexCount++] = &in_tri->proj_tex_points[0]; }
-	if (d1 >= 0) { inside_points[nInsidePointCount++]   = &in_tri->proj_points[1]; inside_tex[nInsideTexCount++]   = &in_tri->proj_tex_points[1]; }
-	else         { outside_points[nOutsidePointCount++] = &in_tri->proj_points[1]; outside_tex[nOutsideTexCount++] = &in_tri->proj_tex_points[1]; }
-	if (d2 >= 0) { inside_points[nInsidePointCount++]   = &in_tri->proj_points[2]; inside_tex[nInsideTexCount++]   = &in_tri->proj_tex_points[2]; }
-	else         { outside_points[nOutsidePointCount++] = &in_tri->proj_points[2]; outside_tex[nOutsideTexCount++] = &in_tri->proj_tex_points[2]; }
-
-	//classify points and break input triangle into smaller trangles if
-	//required. there are four possible outcomes
-
-	float t;
-	if (nInsidePointCount == 0) { 
-	//all points lie outside the plane
-		return 0; 
-	} else if (nInsidePointCount == 3) { 
-	//all points lie inside the plane so do nothing and allow triangle to pass
-		out_tris = {in_tri, 0};
-		return 1; 
-	} else if (nInsidePointCount == 1 && nOutsidePointCount == 2) {
-		Triangle* newTri = new Triangle();
-		newTri->color = in_tri->color;
-		newTri->e = in_tri->e;
-		newTri->e->GetComponent<Mesh>()->texture = in_tri->e->GetComponent<Mesh>()->texture;
-		newTri->is_clip = true; 
-
-		//the inside point is valid so we keep it
-		newTri->proj_points[0] = *inside_points[0];
-		newTri->proj_tex_points[0] = *inside_tex[0];
-		
-		//but the two new points are not where the original triangle intersects with the plane
-		newTri->proj_points[1] = Math::VectorPlaneIntersect(plane_p, plane_n, *inside_points[0], *outside_points[0], t);
-		newTri->proj_tex_points[1].x = t * (outside_tex[0]->x - inside_tex[0]->x) + inside_tex[0]->x;
-		newTri->proj_tex_points[1].y = t * (outside_tex[0]->y - inside_tex[0]->y) + inside_tex[0]->y;
-		newTri->proj_tex_points[1].z = t * (outside_tex[0]->z - inside_tex[0]->z) + inside_tex[0]->z;
-
-		newTri->proj_points[2] = Math::VectorPlaneIntersect(plane_p, plane_n, *inside_points[0], *outside_points[1], t);
-		newTri->proj_tex_points[2].x = t * (outside_tex[1]->x - inside_tex[0]->x) + inside_tex[0]->x;
-		newTri->proj_tex_points[2].y = t * (outside_tex[1]->y - inside_tex[0]->y) + inside_tex[0]->y;
-		newTri->proj_tex_points[2].z = t * (outside_tex[1]->z - inside_tex[0]->z) + inside_tex[0]->z;
-
-		out_tris = {newTri, 0};
-		return 1; //return new triangle
-	} else if (nInsidePointCount == 2 && nOutsidePointCount == 1) {
-	//triangle will be clipped and becomes a quad which is cut into two more triangles
-		Triangle* newTri = new Triangle();
-		newTri->e = in_tri->e;
-		newTri->e->GetComponent<Mesh>()->texture = in_tri->e->GetComponent<Mesh>()->texture;
-		newTri->is_clip = true;
-		newTri->color = in_tri->color;
-
-		newTri->proj_points[0] = *inside_points[0];
-		newTri->proj_points[1] = *inside_points[1];
-		newTri->proj_tex_points[0] = *inside_tex[0];
-		newTri->proj_tex_points[1] = *inside_tex[1];
-
-		newTri->proj_points[2] = Math::VectorPlaneIntersect(plane_p, plane_n, *inside_points[0], *outside_points[0], t);
-		newTri->proj_tex_points[2].x = t * (outside_tex[0]->x - inside_tex[0]->x) + inside_tex[0]->x;
-		newTri->proj_tex_points[2].y = t * (outside_tex[0]->y - inside_tex[0]->y) + inside_tex[0]->y;
-		newTri->proj_tex_points[2].z = t * (outside_tex[0]->z - inside_tex[0]->z) + inside_tex[0]->z;
-
-		Triangle* newTri2 = new Triangle(); //TODO(, sushi) figure out why this is leaking
-		newTri2->color = in_tri->color;
-		newTri2->e = in_tri->e;
-		newTri2->e->GetComponent<Mesh>()->texture = in_tri->e->GetComponent<Mesh>()->texture;
-		newTri2->is_clip = true;
-
-		newTri2->proj_points[0] = *inside_points[1];
-		newTri2->proj_tex_points[0] = *inside_tex[1];
-		newTri2->proj_points[1] = newTri->proj_points[2];
-		newTri2->proj_tex_points[1] = newTri->proj_tex_points[2];
-
-		newTri2->proj_points[2] = Math::VectorPlaneIntersect(plane_p, plane_n, *inside_points[1], *outside_points[0], t);
-		newTri2->proj_tex_points[2].x = t * (outside_tex[0]->x - inside_tex[1]->x) + inside_tex[1]->x;
-		newTri2->proj_tex_points[2].y = t * (outside_tex[0]->y - inside_tex[1]->y) + inside_tex[1]->y;
-		newTri2->proj_tex_points[2].z = t * (outside_tex[0]->z - inside_tex[1]->z) + inside_tex[1]->z;
-
-		out_tris = {newTri, newTri2};
-		return 2;
-	} else {
-		ASSERT(false, "This shouldnt happen");
-		return -1;
+	start = steady_clock::now();
+	if(packet.textures) {
+		rasterizer->Draw(pool, framebuffer, olc::BLACK.n);
 	}
-} //ClipTriangles
-
-int DrawTriangles(Scene* scene, Screen* screen, olc::PixelGameEngine* p, std::list<Triangle*>* list) {
-	int drawnCount = 0;
-
-	for(Triangle* tr : *list) {
-		//draw textures
-		if(scene->RENDER_TEXTURES) {				
-			TexturedTriangle(scene, screen, p, tr);
-		}
+	timings->raster = ElapsedMS(start);
+} //RenderTriangles
 
+//wireframes, edge numbers and screen bounding boxes of the triangles RenderTriangles queued, drawn on top of the fill
+//toScreen scales them from the resolution they were rasterized at up to the screen's
+void DrawTriangleOverlays(Scene* scene, Rasterizer* rasterizer, const std::vector<std::pair<Vector2, Vector2>>& boundingBoxes, float toScreen, olc::PixelGameEngine* p) {
+	for(RasterTriangle& rt : rasterizer->triangles) {
+		Vector3 points[3] = { rt.points[0] * toScreen, rt.points[1] * toScreen, rt.points[2] * toScreen };
 		//draw wireframe
 		if(scene->RENDER_WIREFRAME) {
-			p->DrawTriangle(tr->proj_points[0].x, tr->proj_points[0].y,
-				tr->proj_points[1].x, tr->proj_points[1].y,
-				tr->proj_points[2].x, tr->proj_points[2].y,
+			p->DrawTriangle(points[0].x, points[0].y,
+				points[1].x, points[1].y,
+				points[2].x, points[2].y,
 				olc::WHITE);
 		}
 
 		//draw edges numbers
 		if(scene->RENDER_EDGE_NUMBERS) {
-			tr->display_edges(p);
-		}
-
-		//delete new clipping triangles
-		if(tr->is_clip) {
-			delete tr;
+			Triangle tr;
+			for(int i = 0; i < 3; ++i) { tr.proj_points[i] = points[i]; }
+			tr.display_edges(p);
 		}
-		drawnCount++;
 	}
-
-	return drawnCount;
-}
-
-int RenderTriangles(Scene* scene, Camera* camera, Screen* screen, olc::PixelGameEngine* p) {
-	int drawnTriCount = 0;
-	for(Mesh* mesh : scene->meshes) {
-		std::vector<Vector3*> screenSpaceVertices;
-		for(Triangle& t : mesh->triangles) {
-			if(scene->RENDER_MESH_VERTICES) {
-				scene->lines.push_back(new RenderedEdge3D(t.points[0], t.points[0] + Vector3(0, .01f, 0),	olc::GREEN));
-				scene->lines.push_back(new RenderedEdge3D(t.points[1], t.points[1] + Vector3(0, .01f, 0),	olc::GREEN));
-				scene->lines.push_back(new RenderedEdge3D(t.points[2], t.points[2] + Vector3(0, .01f, 0),	olc::GREEN));
-			}
-
-			t.copy_points(); //copy worldspace points to proj_points
-			t.set_normal();
-			t.set_area();
-
-			Vector3 triNormal = t.get_normal();
-
-			if(scene->RENDER_MESH_NORMALS) {
-				Vector3 mid = t.midpoint();
-				scene->lines.push_back(new RenderedEdge3D(mid, mid + (triNormal * .1f), olc::GREEN));
-			}
-
-			//if the angle between the middle of the triangle and the camera is greater less 90 degrees, it should show
-			if(triNormal.dot(t.midpoint() - camera->position) < 0) {  //TODO(or,delle) see if zClipIndex can remove the .midpoint()
-		//project points to view/camera space
-				for(Vector3& pp : t.proj_points) {
-					pp = Math::WorldToCamera(pp, camera->viewMatrix).ToVector3();
-				}
-
-		//clip to the nearZ plane in view/clip space
-				std::array<Triangle*, 2> zClipped = {};
-				int numZClipped = ClipTriangles(Vector3(0, 0, camera->nearZ), Vector3::FORWARD, &t, zClipped);
-
-				for(int zClipIndex = 0; zClipIndex < numZClipped; ++zClipIndex) {
-					//project to screen
-					for(int pIndex = 0; pIndex < 3; ++pIndex) {
-						float w;
-						zClipped[zClipIndex]->proj_points[pIndex] = Math::CameraToScreen(zClipped[zClipIndex]->proj_points[pIndex], camera->projectionMatrix, screen->dimensions, w);
-						zClipped[zClipIndex]->proj_tex_points[pIndex].x /= w;
-						zClipped[zClipIndex]->proj_tex_points[pIndex].y /= w;
-						zClipped[zClipIndex]->proj_tex_points[pIndex].z = 1.f / w;
-
-						if(scene->RENDER_SCREEN_BOUNDING_BOX) {
-							screenSpaceVertices.push_back(&zClipped[zClipIndex]->proj_points[pIndex]);
-						}
-					}
-					zClipped[zClipIndex]->orig = &t;
-					//zClipped[zClipIndex]->sprite = t.sprite;
-
-		//clip to screen borders in screen space
-					std::list<Triangle*> borderClippedTris;
-					borderClippedTris.push_back(zClipped[zClipIndex]);
-					int newBClippedTris = 1;
-					for(int bClipSide = 0; bClipSide < 4; ++bClipSide) {
-						while(newBClippedTris > 0) {
-							std::array<Triangle*, 2> bClipped = {};
-							Triangle* tri = borderClippedTris.front();
-							borderClippedTris.pop_front();
-							newBClippedTris--;
-
-							int numBClipped = 0;
-							switch(bClipSide) {
-								case 0: { numBClipped = ClipTriangles(Vector3::ZERO,					Vector3::UP,    tri, bClipped); } break;
-								case 1: { numBClipped = ClipTriangles(Vector3(0, screen->height-1, 0),	Vector3::DOWN,  tri, bClipped); } break;
-								case 2: { numBClipped = ClipTriangles(Vector3::ZERO,					Vector3::RIGHT, tri, bClipped); } break;
-								case 3: { numBClipped = ClipTriangles(Vector3(screen->width-1, 0, 0),	Vector3::LEFT,  tri, bClipped); } break;
-							}
-
-							for(int bClipIndex = 0; bClipIndex < numBClipped; ++bClipIndex) {
-								bClipped[bClipIndex]->e->GetComponent<Mesh>()->texture = zClipped[zClipIndex]->e->GetComponent<Mesh>()->texture;
-								bClipped[bClipIndex]->orig = tri->orig;
-								borderClippedTris.push_back(bClipped[bClipIndex]);
-							}
-						}
-						newBClippedTris = borderClippedTris.size();
-					}
-
-		//draw triangles
-					drawnTriCount += DrawTriangles(scene, screen, p, &borderClippedTris);
-				}
-			}
-		}
-		if(scene->RENDER_SCREEN_BOUNDING_BOX && screenSpaceVertices.size() > 0) {
-			Vector3* leftMost;
-			Vector3* rightMost;
-			Vector3* topMost;
-			Vector3* bottomMost;
-
-			std::sort(screenSpaceVertices.begin(), screenSpaceVertices.end(), ([](Vector3* v1, Vector3* v2) {return v1->x > v2->x; }));
-			leftMost = screenSpaceVertices[screenSpaceVertices.size() - 1];
-			rightMost = screenSpaceVertices[0];
-			
-			std::sort(screenSpaceVertices.begin(), screenSpaceVertices.end(), ([](Vector3* v1, Vector3* v2) {return v1->y > v2->y; }));
-			topMost = screenSpaceVertices[screenSpaceVertices.size() - 1];
-			bottomMost = screenSpaceVertices[0];
-
-			p->DrawRect(Vector2(leftMost->x, topMost->y), Vector2(rightMost->x - leftMost->x, bottomMost->y - topMost->y));
-		}
+	for(auto& box : boundingBoxes) {
+		p->DrawRect(box.first * toScreen, box.second * toScreen);
 	}
-	return drawnTriCount;
-} //RenderTriangles
+} //DrawTriangleOverlays
 
 //the input vectors should be in viewMatrix/camera space
 //returns true if the line can be rendered after clipping, false otherwise
@@ -506,341 +430,346 @@ bool ClipLineToBorderPlanes(Vector3& start, Vector3& end, Screen* screen) {
 	}
 } //ClipLineToBorderPlanes
 
-int RenderLines(Scene* scene, Camera* camera, Screen* screen, olc::PixelGameEngine* p) {
+//draws every line in debug as seen by the camera
+int RenderLines(DebugDraw& debug, Camera* camera, Screen* screen, ThreadPool* pool, olc::PixelGameEngine* p) {
+	//convert vertexes from world to camera/viewMatrix space, all at once across the pool
+	debug.Transform(pool, camera->viewMatrix);
+
 	int out = 0;
-	for(Edge3D* l : scene->lines) {
-	//convert vertexes from world to camera/viewMatrix space
-		Vector3 startVertex = Math::WorldToCamera(l->p[0], camera->viewMatrix).ToVector3();
-		Vector3 endVertex = Math::WorldToCamera(l->p[1], camera->viewMatrix).ToVector3();
+	const Matrix4& proj = camera->projectionMatrix;
+	float halfWidth = .5f * screen->width;
+	float halfHeight = .5f * screen->height;
+	auto project = [&](const Vector3& c) {
+		Vector4 clip = Vector4(c.x, c.y, c.z, 1.f) * proj;
+		return Vector3((clip.x / clip.w + 1.f) * halfWidth, (clip.y / clip.w + 1.f) * halfHeight, clip.z / clip.w);
+	};
+	for(uint32 i = 0; i < debug.LineCount(); ++i) {
+		Vector3 startVertex = debug.viewPoints[2 * i];
+		Vector3 endVertex = debug.viewPoints[2 * i + 1];
 
 	//clip vertexes to the near and far z planes in camera/viewMatrix space
 		if (!ClipLineToZPlanes(startVertex, endVertex, camera)) { continue; }
 
 	//convert vertexes from camera/viewMatrix space to clip space
-		startVertex = Math::CameraToScreen(startVertex, camera->projectionMatrix, screen->dimensions);
-		endVertex = Math::CameraToScreen(endVertex, camera->projectionMatrix, screen->dimensions);
+		startVertex = project(startVertex);
+		endVertex = project(endVertex);
 
 	//clip vertexes to border planes in clip space
 		if (!ClipLineToBorderPlanes(startVertex, endVertex, screen)) { continue; }
 
 	//draw the lines after all clipping and space conversion
 		++out;
-		p->DrawLine(startVertex.ToVector2(), endVertex.ToVector2(), ((RenderedEdge3D*)l)->color);
+		p->DrawLine(startVertex.ToVector2(), endVertex.ToVector2(), olc::Pixel(debug.colors[i]));
 	}
 	return out;
 } //RenderLines
 
+//// Stats ////
+
+std::string RenderCounters::str(const RenderTimings& t) const {
+	char buffer[1024];
+	std::snprintf(buffer, sizeof(buffer),
+		"gather    %7.3f ms  %d meshes, %d triangles\n"
+		"cull      %7.3f ms  %d meshes and %d triangles outside the frustum, %d triangles submitted\n"
+		"shadow    %7.3f ms\n"
+		"vertex    %7.3f ms\n"
+		"occlusion %7.3f ms  %d meshes and %d triangles occluded\n"
+		"setup     %7.3f ms  %d back-facing, %d clipped, %d offscreen, %d rasterized\n"
+		"bin       %7.3f ms\n"
+		"raster    %7.3f ms  %u px written, %u px covered, %u px hi-z rejected\n"
+		"shade     %7.3f ms  %u px shaded\n"
+		"present   %7.3f ms\n"
+		"lines     %7.3f ms  %d drawn\n"
+		"ui        %7.3f ms%s",
+		t.gather, meshes, trianglesTotal,
+		t.cull, meshesCulled, trianglesCulled, trianglesSubmitted,
+		t.shadow,
+		t.vertex,
+		t.occlusion, meshesOccluded, trianglesOccluded,
+		t.setup, trianglesBackFacing, trianglesClipped, trianglesOffscreen, trianglesRasterized,
+		t.bin,
+		t.raster, pixelsWritten, pixelsCovered, pixelsHizRejected,
+		t.shade, pixelsShaded,
+		t.present,
+		t.lines, linesDrawn,
+		t.ui, reused ? "\nthe last frame was reused, nothing it was drawn from changed" : "");
+	return std::string(buffer);
+}
 
-//this (probably) generates a light's depth texture for use in shadow casting
-//currently set up to work for directional lights
-void LightDepthTex(Light* li, Camera* c, Scene* s, Screen* sc) {
-	int resx = 1024;
-	int resy = 1024; //resolution of depth texture
-	li->depthTexture = std::vector<int>((size_t)resx * (size_t)resy);
-	
-	//once we implement point lights we'll start making a bounding box around
-	//only what the camera sees but for now this is how it works with ortho projection
-	std::pair<Vector3, Vector3> bbox = s->SceneBoundingBox();
-
-	Matrix4 lightViewMat = Math::LookAtMatrix(li->position, li->direction);
-
-	//convert bounding box to light's "view" space
-	Vector3 maxcam = Math::WorldToCamera(bbox.first,  lightViewMat).ToVector3();
-	Vector3 mincam = Math::WorldToCamera(bbox.second, lightViewMat).ToVector3();
-
-	//make screen box from camera space bounding box
-	float maxx = std::max(fabs(mincam.x), fabs(maxcam.x));
-	float maxy = std::max(fabs(mincam.y), fabs(maxcam.y));
-	float max = std::max(maxx, maxy);
-
-	float aspectRatio = sc->height / sc->width;
-	float r = max * aspectRatio, t = max;
-	float l = -r, b = -t;
-
-	//make ortho proj mat for directional light
-	//NOTE: ortho projection may not work properly yet
-	Matrix4 ortho = Math::MakeOrthoProjMat(r, l, t, b, c->farZ, c->nearZ);
-
-	//std::vector<Triangle> tris;
-
-	Vector2 res(resx, resy);
-
-	//render the scene with respect to the light
-	//what im dloing is just projecting each triangle and rendering them instead
-	//of projecting them each individually. i dont know if this is more efficient or not
-	for (Mesh* m : s->meshes) {
-		for (Triangle tri : m->triangles) {
-
-			//project triangle to light's 'view'
-			tri.copy_points();
-			for (Vector3 v : tri.proj_points) {
-				v = Math::WorldToCamera(v, lightViewMat).ToVector3();
-				//LOG(v);
-				
-				
-			}
-
-			//project triangle to light's 'screen'
-			for (int i = 0; i < 3; i++) {
-				float w;
-				tri.proj_points[i] = Math::CameraToScreen(tri.proj_points[i], ortho, res, w);
-				tri.proj_tex_points[i].x /= w;
-				tri.proj_tex_points[i].y /= w;
-				tri.proj_tex_points[i].z = 1.f / w;
-				//LOG(w);
-			}
+//// Frame Reuse ////
 
-			//gather world vertices to lerp between later
-			Vector3 ve1 = tri.points[0];
-			Vector3 ve2 = tri.points[1];
-			Vector3 ve3 = tri.points[2];
-			
-			int x1 = tri.proj_points[0].x; int x2 = tri.proj_points[1].x; int x3 = tri.proj_points[2].x;
-			int y1 = tri.proj_points[0].y; int y2 = tri.proj_points[1].y; int y3 = tri.proj_points[2].y;
-
-			float u1 = tri.proj_tex_points[0].x; float u2 = tri.proj_tex_points[1].x; float u3 = tri.proj_tex_points[2].x;
-			float v1 = tri.proj_tex_points[0].y; float v2 = tri.proj_tex_points[1].y; float v3 = tri.proj_tex_points[2].y;
-			float w1 = tri.proj_tex_points[0].z; float w2 = tri.proj_tex_points[1].z; float w3 = tri.proj_tex_points[2].z;
-
-			if (y2 < y1) { std::swap(y1, y2); std::swap(x1, x2); std::swap(u1, u2); std::swap(v1, v2); std::swap(w1, w2); }
-			if (y3 < y1) { std::swap(y1, y3); std::swap(x1, x3); std::swap(u1, u3); std::swap(v1, v3); std::swap(w1, w3); }
-			if (y3 < y2) { std::swap(y2, y3); std::swap(x2, x3); std::swap(u2, u3); std::swap(v2, v3); std::swap(w2, w3); }
-
-			//sort world vertices so ve1 is highest and ve3 is lowest
-			if (ve2.y < ve1.y) { std::swap(ve1, ve2); }
-			if (ve3.y < ve1.y) { std::swap(ve1, ve3); }
-			if (ve3.y < ve2.y) { std::swap(ve2, ve3); }
-
-			int dy1 = y2 - y1;
-			int dx1 = x2 - x1;
-			float dv1 = v2 - v1;
-			float du1 = u2 - u1;
-			float dw1 = w2 - w1;
-
-			int dy2 = y3 - y1;
-			int dx2 = x3 - x1;
-			float dv2 = v3 - v1;
-			float du2 = u3 - u1;
-			float dw2 = w3 - w1;
-
-			float tex_u, tex_v, tex_w;
-
-			float	dax_step = 0, dbx_step = 0,
-					du1_step = 0, dv1_step = 0,
-					du2_step = 0, dv2_step = 0,
-					dw1_step = 0, dw2_step = 0;
-
-			if (dy1) dax_step = dx1 / (float)abs(dy1);
-			if (dy2) dbx_step = dx2 / (float)abs(dy2);
-
-			if (dy1) du1_step = du1 / (float)abs(dy1);
-			if (dy1) dv1_step = dv1 / (float)abs(dy1);
-			if (dy1) dw1_step = dw1 / (float)abs(dy1);
-
-			if (dy2) du2_step = du2 / (float)abs(dy2);
-			if (dy2) dv2_step = dv2 / (float)abs(dy2);
-			if (dy2) dw2_step = dw2 / (float)abs(dy2);
-
-			if (dy1) {
-				for (int i = y1; i <= y2; i++) {
-					int ax = x1 + (float)(i - y1) * dax_step;
-					int bx = x1 + (float)(i - y1) * dbx_step;
-
-					float tex_su = u1 + (float)(i - y1) * du1_step;
-					float tex_sv = v1 + (float)(i - y1) * dv1_step;
-					float tex_sw = w1 + (float)(i - y1) * dw1_step;
-
-					float tex_eu = u1 + (float)(i - y1) * du2_step;
-					float tex_ev = v1 + (float)(i - y1) * dv2_step;
-					float tex_ew = w1 + (float)(i - y1) * dw2_step;
-
-					if (ax > bx) {
-						std::swap(ax, bx);
-						std::swap(tex_su, tex_eu);
-						std::swap(tex_sv, tex_ev);
-						std::swap(tex_sw, tex_ew);
-					}
-
-					tex_u = tex_su;
-					tex_v = tex_sv;
-					tex_w = tex_sw;
-
-					float tstep = 1.0f / ((float)(bx - ax));
-					float t = 0.0f;
-
-					for (int j = ax; j < bx; j++) {
-						tex_u = (1.0f - t) * tex_su + t * tex_eu;
-						tex_v = (1.0f - t) * tex_sv + t * tex_ev;
-						tex_w = (1.0f - t) * tex_sw + t * tex_ew;
-
-						//use the interpolation to find the point the pixel is drawing in world space 
-						//Vector3 worldp()
-
-
-						if (tex_w > li->depthTexture[i * (size_t)resx + j]) {
-							li->depthTexture[i * (size_t)resx + j] = tex_w;
-							//LOG(tex_w);
-						}
-						t += tstep;
-					}
-				}
-			}
+inline bool SameMatrix(const Matrix4& a, const Matrix4& b) {
+	return std::memcmp(a.data, b.data, sizeof(a.data)) == 0;
+}
 
-			dy1 = y3 - y2;
-			dx1 = x3 - x2;
-			dv1 = v3 - v2;
-			du1 = u3 - u2;
-			dw1 = w3 - w2;
-
-			if (dy1) dax_step = dx1 / (float)abs(dy1);
-			if (dy2) dbx_step = dx2 / (float)abs(dy2);
-
-			du1_step = 0, dv1_step = 0;
-			if (dy1) du1_step = du1 / (float)abs(dy1);
-			if (dy1) dv1_step = dv1 / (float)abs(dy1);
-			if (dy1) dw1_step = dw1 / (float)abs(dy1);
-
-			if (dy1) {
-				for (int i = y2; i <= y3; i++) {
-					int ax = x2 + (float)(i - y2) * dax_step;
-					int bx = x1 + (float)(i - y1) * dbx_step;
-
-					float tex_su = u2 + (float)(i - y2) * du1_step;
-					float tex_sv = v2 + (float)(i - y2) * dv1_step;
-					float tex_sw = w2 + (float)(i - y2) * dw1_step;
-
-					float tex_eu = u1 + (float)(i - y1) * du2_step;
-					float tex_ev = v1 + (float)(i - y1) * dv2_step;
-					float tex_ew = w1 + (float)(i - y1) * dw2_step;
-
-					if (ax > bx) {
-						std::swap(ax, bx);
-						std::swap(tex_su, tex_eu);
-						std::swap(tex_sv, tex_ev);
-						std::swap(tex_sw, tex_ew);
-					}
-
-					tex_u = tex_su;
-					tex_v = tex_sv;
-					tex_w = tex_sw;
-
-					float tstep = 1.0f / ((float)(bx - ax));
-					float t = 0.0f;
-
-					for (int j = ax; j < bx; j++) {
-						tex_u = (1.0f - t) * tex_su + t * tex_eu;
-						tex_v = (1.0f - t) * tex_sv + t * tex_ev;
-						tex_w = (1.0f - t) * tex_sw + t * tex_ew;
-
-						if (tex_w > li->depthTexture[i * (size_t)resx + j]) {
-							li->depthTexture[i * (size_t)resx + j] = tex_w;
-							//LOG(tex_w);
-						}
-						t += tstep;
-					}
-				}
-			}
+inline bool SameMeshes(const std::vector<FrameKey::MeshKey>& a, const std::vector<FrameKey::MeshKey>& b) {
+	if(a.size() != b.size()) { return false; }
+	for(size_t i = 0; i < a.size(); ++i) {
+		if(a[i].mesh != b[i].mesh || a[i].version != b[i].version || a[i].texture != b[i].texture ||
+		   a[i].lodLevel != b[i].lodLevel || a[i].occluder != b[i].occluder || !SameMatrix(a[i].model, b[i].model)) {
+			return false;
 		}
 	}
+	return true;
+}
 
+//fills key with everything the packet's framebuffer depends on, keeping its memory
+void BuildFrameKey(const RenderPacket& packet, FrameKey& key) {
+	key.view = packet.camera.viewMatrix;
+	key.projection = packet.camera.projectionMatrix;
+	key.width = packet.renderScreen.width;
+	key.height = packet.renderScreen.height;
+	key.flags = (packet.textures ? 1 : 0) | (packet.visibilityBuffer ? 2 : 0) | (packet.occlusionCulling ? 4 : 0) | (packet.boundingBoxes ? 8 : 0);
+	key.light = packet.light;
+	key.lightDirection = packet.lightDirection;
+	key.shadowResolution = packet.shadowResolution;
+	key.meshes.clear();
+	for(const MeshInstance& instance : packet.meshes) {
+		key.meshes.push_back({ instance.mesh, instance.mesh->version, instance.mesh->texture, instance.model, instance.lodLevel, instance.occluder });
+	}
+	key.casters.clear();
+	for(size_t i = 0; i < packet.casters.size(); ++i) {
+		key.casters.push_back({ packet.casters[i], packet.casters[i]->version, nullptr, packet.casterModels[i], 0, false });
+	}
+	key.valid = true;
+}
 
-
+//Vector3::operator== has a tolerance, but any change at all can move a pixel
+bool SameFrame(const FrameKey& a, const FrameKey& b) {
+	return a.valid && b.valid && a.width == b.width && a.height == b.height && a.flags == b.flags &&
+		   SameMatrix(a.view, b.view) && SameMatrix(a.projection, b.projection) && a.light == b.light &&
+		   a.lightDirection.x == b.lightDirection.x && a.lightDirection.y == b.lightDirection.y && a.lightDirection.z == b.lightDirection.z &&
+		   a.shadowResolution == b.shadowResolution && SameMeshes(a.meshes, b.meshes) && SameMeshes(a.casters, b.casters);
 }
 
-void RenderSceneSystem::Update() {
+//// Pipeline ////
+
+void RenderSceneSystem::Extract() {
 	Scene* scene = admin->currentScene;
 	Camera* camera = admin->currentCamera;
-	Input* input = admin->input;
-	Keybinds* binds = admin->currentKeybinds;
 	Screen* screen = admin->screen;
-	olc::PixelGameEngine* p = admin->p;
-
-//// Scene Manangement ////
-
-	//reset the scene
-	scene->pixelDepthBuffer = std::vector<float>((size_t)screen->width * (size_t)screen->height);
+	steady_clock::time_point gatherStart = steady_clock::now();
+	frameCounters = RenderCounters();
+
+	//triangles are rasterized at the dynamic resolution's scale of the screen and stretched over it when presented
+	//the framebuffer is only reallocated when that size changes, the rasterizer clears it as it draws
+	float scale = scene->DYNAMIC_RESOLUTION ? resolution.scale : 1.f;
+	packet.screen = *screen;
+	packet.renderScreen = (scale < 1.f) ? Screen(resolution.Scaled(screen->width), resolution.Scaled(screen->height)) : *screen;
+	scene->framebuffer.Resize(packet.renderScreen.width, packet.renderScreen.height);
 	scene->meshes.clear();
-	for(auto l : scene->lights) { if(!l->entity) delete l; }
 	scene->lights.clear();
-	for(Edge3D* l : scene->lines) { if(!l->e) delete l; }
-	scene->lines.clear();
+
+	packet.camera = *camera;
+	packet.textures = scene->RENDER_TEXTURES;
+	packet.boundingBoxes = scene->RENDER_SCREEN_BOUNDING_BOX;
+	//occlusion culling is skipped with ortho for the same reason as frustum culling
+	packet.occlusionCulling = scene->OCCLUSION_CULLING && !USE_ORTHO;
+	packet.visibilityBuffer = scene->VISIBILITY_BUFFER;
+	packet.texts.clear();
+	packet.rendered = false;
+
+	//the lines added since the last extract belong to this packet, and the last packet's already presented lines
+	//are cleared to collect the next frame's
+	std::swap(packet.debug, scene->debug);
+	scene->debug.Clear();
+	DebugDraw& debug = packet.debug;
+
+	//Physics is written by the physics thread while its running, so the vectors are drawn from its last published tick instead
+	PhysicsSystem* physicsSystem = scene->RENDER_PHYSICS ? admin->GetSystem<PhysicsSystem>() : nullptr;
+	bool physicsThreaded = physicsSystem && physicsSystem->threadRunning;
 
 	//collect all meshes and transform lines
-	int totalTriCount = 0;
-	std::vector<std::pair<Vector2, std::string>> render_transforms;
 	for(auto pair : admin->entities) {
 		for(Component* comp : pair.second->components) {
 			if(Mesh* mesh = dynamic_cast<Mesh*>(comp)) {
 				scene->meshes.push_back(mesh);
-				totalTriCount += mesh->triangles.size();
+				frameCounters.trianglesTotal += mesh->triangles.size();
 			}
 			/*if(SpriteRenderer* sr = dynamic_cast<SpriteRenderer*>(comp)) { //idea for 2d drawing
 			
 			}*/
 			if(Transform* t = dynamic_cast<Transform*>(comp)) {
 				if(scene->RENDER_LOCAL_AXIS) {
-					scene->lines.push_back(new RenderedEdge3D(t->position, t->position + t->Right(), olc::RED));
-					scene->lines.push_back(new RenderedEdge3D(t->position, t->position + t->Up(), olc::GREEN));
-					scene->lines.push_back(new RenderedEdge3D(t->position, t->position + t->Forward(), olc::BLUE));
+					debug.Line(t->position, t->position + t->Right(), olc::RED);
+					debug.Line(t->position, t->position + t->Up(), olc::GREEN);
+					debug.Line(t->position, t->position + t->Forward(), olc::BLUE);
 				}
 				if(scene->RENDER_TRANSFORMS) {
 					Vector2 pos = Math::WorldToScreen2D(t->position, camera->projectionMatrix, camera->viewMatrix, screen->dimensions);
-					render_transforms.push_back(std::make_pair(pos, t->position.str2f()));
-					render_transforms.push_back(std::make_pair(pos + Vector2(0, 10), t->rotation.str2f()));
+					packet.texts.push_back(std::make_pair(pos, t->position.str2f()));
+					packet.texts.push_back(std::make_pair(pos + Vector2(0, 10), t->rotation.str2f()));
 				}
 			}
-			if(scene->RENDER_PHYSICS) {
+			if(scene->RENDER_PHYSICS && !physicsThreaded) {
 				if(Physics* phys = dynamic_cast<Physics*>(comp)) {
-					scene->lines.push_back(new RenderedEdge3D(phys->position + phys->velocity, phys->position, olc::DARK_MAGENTA));
-					scene->lines.push_back(new RenderedEdge3D(phys->position + phys->acceleration, phys->position, olc::DARK_YELLOW));
+					debug.Line(phys->position + phys->velocity, phys->position, olc::DARK_MAGENTA);
+					debug.Line(phys->position + phys->acceleration, phys->position, olc::DARK_YELLOW);
 				}
 			}
 		}
 	}
+	if(physicsThreaded) {
+		PhysicsSnapshot& snapshot = physicsSystem->snapshots.Front(); //only swapped by PhysicsSystem::Update on this thread
+		if(snapshot.generation == admin->physicsWorld->generation) {
+			for(BodyState& b : snapshot.bodies) {
+				debug.Line(b.position + b.velocity, b.position, olc::DARK_MAGENTA);
+				debug.Line(b.position + b.acceleration, b.position, olc::DARK_YELLOW);
+			}
+		}
+	}
 
-	scene->lights.push_back(new Light(Vector3(0, 1.5, 1), Vector3(0, 0, 1))); //TODO replace this with light components on entities
-
-//// Scene Rendering ////
+	scene->lights.push_back(defaultLight);
+	packet.lightPosition = scene->lights[0]->position;
 
 	//render world grid
 	if(scene->RENDER_GRID) {
 		for(int i = -20; i < 21; ++i) {
-			scene->lines.push_back(new RenderedEdge3D(Vector3(-100, 0, i*5), Vector3(100, 0, i*5), olc::GREY));
-			scene->lines.push_back(new RenderedEdge3D(Vector3(i*5, 0, -100), Vector3(i*5, 0, 100), olc::GREY));
+			debug.Line(Vector3(-100, 0, i*5), Vector3(100, 0, i*5), olc::GREY);
+			debug.Line(Vector3(i*5, 0, -100), Vector3(i*5, 0, 100), olc::GREY);
 		}
-		scene->lines.push_back(new RenderedEdge3D(Vector3(-100, 0, 0), Vector3(100, 0, 0), olc::RED));
-		scene->lines.push_back(new RenderedEdge3D(Vector3(0, 0, -100), Vector3(0, 0, 100), olc::BLUE));
+		debug.Line(Vector3(-100, 0, 0), Vector3(100, 0, 0), olc::RED);
+		debug.Line(Vector3(0, 0, -100), Vector3(0, 0, 100), olc::BLUE);
 	}
 
 	//render light rays
 	if(scene->RENDER_LIGHT_RAYS) {
 		for(Light* l : scene->lights) {
-			scene->lines.push_back(new RenderedEdge3D(l->position, l->position + (l->direction * l->strength), olc::YELLOW));
+			debug.Line(l->position, l->position + (l->direction * l->strength), olc::YELLOW);
 		}
 	}
 
-	//generate light's depth texture
-	//for (Light* l : scene->lights) {
-	//	LightDepthTex(l, camera, scene, screen);
-	//}
+	//the first light with shadows shadows the scene
+	packet.light = nullptr;
+	packet.casters.clear();
+	packet.casterModels.clear();
+	if(scene->RENDER_SHADOWS) {
+		for(Light* light : scene->lights) {
+			if(light->shadowUpdate != Light::SHADOW_UPDATE_NONE) {
+				packet.light = light;
+				packet.lightDirection = light->direction;
+				packet.shadowResolution = light->shadowResolution;
+				packet.shadowUpdate = light->shadowUpdate;
+				break;
+			}
+		}
+		if(packet.light) {
+			for(Mesh* mesh : scene->meshes) {
+				if(mesh->castsShadows) {
+					packet.casters.push_back(mesh);
+					packet.casterModels.push_back(VertexStage::ModelMatrix(mesh));
+				}
+			}
+		}
+	}
 
+	//cull meshes outside the view and pick the level of detail of the rest
+	steady_clock::time_point start = steady_clock::now();
+	frameCounters.meshesCulled = CullMeshes(scene, &packet.camera, packet.meshes, frameCounters.trianglesCulled);
+	SelectLODs(packet.meshes, &packet.camera, &packet.renderScreen, scene->LEVEL_OF_DETAIL);
+	frameTimings.cull = ElapsedMS(start);
+	frameCounters.meshes = scene->meshes.size();
+
+	//the framebuffer still holds the last drawn frame, so if this one would come out the same it isnt drawn again
+	BuildFrameKey(packet, nextKey);
+	packet.reused = scene->REUSE_FRAMES && SameFrame(nextKey, drawnKey);
+	if(!packet.reused) { std::swap(nextKey, drawnKey); }
+
+	for(const MeshInstance& instance : packet.meshes) {
+		Mesh* mesh = instance.mesh;
+		frameCounters.trianglesSubmitted += mesh->LODIndices(instance.lodLevel).size() / 3;
+		if(scene->RENDER_MESH_BOUNDS) {
+			debug.Box(mesh->boundsMin, mesh->boundsMax, olc::CYAN, instance.model);
+			debug.Sphere(mesh->sphereCenter * instance.model, mesh->sphereRadius, olc::DARK_CYAN);
+		}
+		if(scene->RENDER_MESH_VERTICES || scene->RENDER_MESH_NORMALS) {
+			//drawn from the level thats rendered, so they match what's on screen
+			const std::vector<Vector3>& lodVertices = mesh->LODVertices(instance.lodLevel);
+			const std::vector<uint32>& lodIndices = mesh->LODIndices(instance.lodLevel);
+			for(size_t i = 0; i + 2 < lodIndices.size(); i += 3) {
+				Vector3 points[3];
+				for(int k = 0; k < 3; ++k) { points[k] = lodVertices[lodIndices[i + k]] * instance.model; }
+				if(scene->RENDER_MESH_VERTICES) {
+					debug.Line(points[0], points[0] + Vector3(0, .01f, 0), olc::GREEN);
+					debug.Line(points[1], points[1] + Vector3(0, .01f, 0), olc::GREEN);
+					debug.Line(points[2], points[2] + Vector3(0, .01f, 0), olc::GREEN);
+				}
 
-	//render triangles
-	int drawnTriCount = RenderTriangles(scene, camera, screen, p);
+				if(scene->RENDER_MESH_NORMALS) {
+					Vector3 mid = (points[0] + points[1] + points[2]) / 3.f;
+					Vector3 normal = (points[1] - points[0]).trueCross(points[2] - points[0]).normalized();
+					debug.Line(mid, mid + (normal * .1f), olc::GREEN);
+				}
+			}
+		}
+	}
+	frameTimings.gather = ElapsedMS(gatherStart) - frameTimings.cull;
+} //Extract
+
+void RenderSceneSystem::Render() {
+	//the framebuffer, the rasterizer's triangles and the screen boxes are all still the last drawn frame's
+	if(packet.reused) {
+		frameTimings.shadow = frameTimings.vertex = frameTimings.occlusion = frameTimings.setup = 0;
+		frameTimings.bin = frameTimings.raster = frameTimings.shade = 0;
+		frameCounters = drawnCounters;
+		frameCounters.reused = true;
+		packet.rendered = true;
+		return;
+	}
 
-	//render lines
-	int drawnLineCount = RenderLines(scene, camera, screen, p);
+	//bring the shadow map up to date
+	steady_clock::time_point start = steady_clock::now();
+	const ShadowMap* shadow = nullptr;
+	if(packet.light) {
+		UpdateShadowMap(packet, &pool);
+		if(packet.light->shadowMap.valid) { shadow = &packet.light->shadowMap; }
+	}
+	frameTimings.shadow = ElapsedMS(start);
+
+	OcclusionBuffer* occluders = packet.occlusionCulling ? &occlusion : nullptr;
+	rasterizer.visibilityBuffer = packet.visibilityBuffer;
+	RenderTriangles(packet, &admin->currentScene->framebuffer, &rasterizer, &vertexStage, occluders, shadow, &pool, &frameTimings, &frameCounters);
+
+	//the rasterizer only counts pixels when it fills
+	if(packet.textures) {
+		frameCounters.pixelsWritten = rasterizer.writtenPixels;
+		frameCounters.pixelsShaded = rasterizer.shadedPixels;
+		frameCounters.pixelsCovered = rasterizer.coveredPixels;
+		frameCounters.pixelsHizRejected = rasterizer.hizRejectedPixels;
+	}
+	frameTimings.shade = (packet.textures && packet.visibilityBuffer) ? rasterizer.shadeMS : 0;
+	drawnCounters = frameCounters;
+	packet.rendered = true;
+} //Render
 
-	//render light depth texture for debugin'
-	//for (int i : scene->lights[0]->depthTexture) {
-	//	p->Draw(Vector2(i / 1028, i % 1028), olc::Pixel(50 * i, 50 * i, 50 * i));
-	//}
+void RenderSceneSystem::Present() {
+	Scene* scene = admin->currentScene;
+	olc::PixelGameEngine* p = admin->p;
+	//the frame is drawn as the camera saw it when it was extracted
+	Camera* camera = &packet.camera;
+	Screen* screen = &packet.screen;
+
+	//copy the fill to the screen in one go, then draw everything else on top of it
+	steady_clock::time_point start = steady_clock::now();
+	if(packet.textures) {
+		scene->framebuffer.BlitScaled(p->GetDrawTarget());
+	}
+	timings.present = ElapsedMS(start);
+
+	//the overlays before and after the lines are both ui
+	start = steady_clock::now();
+	DrawTriangleOverlays(scene, &rasterizer, packet.screenBoxes, screen->width / packet.renderScreen.width, p);
+	timings.ui = ElapsedMS(start);
+
+	//render lines
+	start = steady_clock::now();
+	counters.linesDrawn = RenderLines(packet.debug, camera, screen, &pool, p);
+	timings.lines = ElapsedMS(start);
+	start = steady_clock::now();
 
 	//render transform texts
-	if(scene->RENDER_TRANSFORMS) {
-		for(auto& pair : render_transforms) {
-			p->DrawString(pair.first, pair.second);
-		}
+	for(auto& pair : packet.texts) {
+		p->DrawString(pair.first, pair.second);
 	}
 
 	//render global axis in top right of screen
@@ -854,8 +783,25 @@ void RenderSceneSystem::Update() {
 		p->DrawLine(Vector2(screen->dimensions.x-50, 50), Vector2(screen->dimensions.x-50, 50) + (zVertex-zeroVertex).norm()*20, olc::BLUE);
 	}
 
-	p->DrawCircle(Math::WorldToScreen2D(scene->lights[0]->position, camera->projectionMatrix, camera->viewMatrix, screen->dimensions), 10);
-	p->DrawStringDecal(olc::vf2d(screen->width-300, screen->height - 10), "Tri Total: " + std::to_string(totalTriCount) + "  Tri Drawn: " + std::to_string(drawnTriCount));
+	p->DrawCircle(Math::WorldToScreen2D(packet.lightPosition, camera->projectionMatrix, camera->viewMatrix, screen->dimensions), 10);
+	p->DrawStringDecal(olc::vf2d(screen->width-300, screen->height - 10), "Tri Total: " + std::to_string(counters.trianglesTotal) + "  Tri Drawn: " + std::to_string(counters.trianglesRasterized));
+	p->DrawStringDecal(olc::vf2d(screen->width-300, screen->height - 20), "Mesh Culled: " + std::to_string(counters.meshesCulled) + "  Tri Culled: " + std::to_string(counters.trianglesCulled));
+	if(packet.occlusionCulling) {
+		p->DrawStringDecal(olc::vf2d(screen->width-300, screen->height - 60), "Mesh Occluded: " + std::to_string(counters.meshesOccluded) + "  Tri Occluded: " + std::to_string(counters.trianglesOccluded));
+	}
+	p->DrawStringDecal(olc::vf2d(screen->width-300, screen->height - 50), "Hi-Z Rejected: " + std::to_string(counters.pixelsHizRejected) + " px");
+	if(packet.textures) {
+		char overdraw[16];
+		std::snprintf(overdraw, sizeof(overdraw), "%.2f", counters.pixelsCovered ? (float)counters.pixelsWritten / counters.pixelsCovered : 0.f);
+		p->DrawStringDecal(olc::vf2d(screen->width-300, screen->height - 70), "Overdraw: " + std::string(overdraw) + "x  Shaded: " + std::to_string(counters.pixelsShaded) + " px");
+	}
+	if(counters.reused) {
+		p->DrawStringDecal(olc::vf2d(screen->width-300, screen->height - 90), "Frame Reused");
+	}
+	if(packet.renderScreen.width != screen->width) {
+		p->DrawStringDecal(olc::vf2d(screen->width-300, screen->height - 80), "Resolution: " + std::to_string((int32)packet.renderScreen.width) + "x" + std::to_string((int32)packet.renderScreen.height));
+	}
+	timings.ui += ElapsedMS(start);
 
 	if (admin->paused) {
 		Vector2 tsize = p->GetTextSize("ENGINE PAUSED") * 5;
@@ -865,6 +811,100 @@ void RenderSceneSystem::Update() {
 		float mod = (sinf((4 * admin->time->totalTime) + modmod) + 1) / 2; //nice looking flash effect
 		p->DrawStringDecal(Vector2(0, admin->screen->height - tsize.y), "ENGINE PAUSED", col * mod , Vector2(5, 5));
 	}
+} //Present
 
+void RenderSceneSystem::StartThread() {
+	threadRunning = true;
+	thread = std::thread(&RenderSceneSystem::ThreadLoop, this);
+}
 
+void RenderSceneSystem::StopThread() {
+	{
+		std::lock_guard<std::mutex> lock(frameMutex);
+		threadRunning = false;
+	}
+	frameQueued.notify_one();
+	if(thread.joinable()) { thread.join(); }
+}
+
+//renders each packet the main thread queues until StopThread(), a queued packet is always finished before it stops
+//the main thread waits on it with WaitForFrame before deleting meshes the packet might point at
+void RenderSceneSystem::ThreadLoop() {
+	std::unique_lock<std::mutex> lock(frameMutex);
+	while(true) {
+		frameQueued.wait(lock, [this] { return framePending || !threadRunning; });
+		if(!framePending) { break; }
+		lock.unlock();
+
+		Render();
+
+		lock.lock();
+		framePending = false;
+		frameDone.notify_all();
+	}
+}
+
+void RenderSceneSystem::WaitForFrame() {
+	std::unique_lock<std::mutex> lock(frameMutex);
+	frameDone.wait(lock, [this] { return !framePending; });
+}
+
+RenderSceneSystem::~RenderSceneSystem() {
+	if(threadRunning) { StopThread(); }
+}
+
+//feeds the dynamic resolution the raster time of the frame that was just finished, its scale is picked up by the next Extract
+void RenderSceneSystem::UpdateResolution() {
+	bool enabled = admin->currentScene->DYNAMIC_RESOLUTION;
+	if(enabled && !resolutionEnabled) { resolution.Reset(); }
+	resolutionEnabled = enabled;
+	//a reused frame wasnt rasterized, so it says nothing about the raster time
+	if(enabled && packet.textures && !counters.reused) { resolution.Update(timings.raster); }
+}
+
+void RenderSceneSystem::Update() {
+	//headless admins render in step so the frame is in the framebuffer when Update returns
+	bool threaded = admin->currentScene->RENDER_THREADED && admin->p;
+	if(threaded != threadRunning) {
+		if(threaded) { StartThread(); }
+		else { StopThread(); }
+	}
+
+	if(threadRunning) {
+		//show the frame the render thread drew while this one was simulated, then hand it the next
+		WaitForFrame();
+		if(packet.rendered) {
+			timings = frameTimings;
+			counters = frameCounters;
+			UpdateResolution();
+			Present();
+		}
+		Extract();
+		{
+			std::lock_guard<std::mutex> lock(frameMutex);
+			framePending = true;
+		}
+		frameQueued.notify_one();
+	} else {
+		Extract();
+		Render();
+		timings = frameTimings;
+		counters = frameCounters;
+		UpdateResolution();
+		if(admin->p) {
+			Present();
+		} else {
+			timings.present = 0;
+			timings.lines = 0;
+			timings.ui = 0;
+		}
+	}
+
+	//when nothing has changed for a few frames theres no reason to spin the cpu redrawing the same thing, so the
+	//frame is stretched out to IDLE_FRAME_MS, anything that changes what's drawn goes straight back to full speed
+	idleFrames = counters.reused ? idleFrames + 1 : 0;
+	if(admin->p && admin->currentScene->IDLE_THROTTLE && idleFrames >= IDLE_FRAMES) {
+		std::this_thread::sleep_until(lastFrame + std::chrono::milliseconds(IDLE_FRAME_MS));
+	}
+	lastFrame = steady_clock::now();
 } //Update
@@ -1,7 +1,168 @@
 #pragma once
 #include "System.h"
+#include "../render/Rasterizer.h"
+#include "../render/VertexStage.h"
+#include "../render/OcclusionBuffer.h"
+#include "../render/DebugDraw.h"
+#include "../render/DynamicResolution.h"
+#include "../utils/ThreadPool.h"
+#include "../components/Camera.h"
+#include "../components/Screen.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+struct Mesh;
+struct Light;
+struct ShadowMap;
+
+//how long each stage of the last frame took in milliseconds
+struct RenderTimings {
+	double gather = 0;	//collecting the scene's meshes, lights and debug lines into the packet
+	double shadow = 0;	//rendering shadow maps that were out of date
+	double cull = 0;	//frustum culling meshes and picking their levels of detail
+	double vertex = 0;	//the vertex stage
+	double occlusion = 0;	//drawing occluders and building the depth pyramid, overlaps the vertex stage
+	double setup = 0;	//back-face culling, clipping and queueing triangles
+	double bin = 0;		//sorting triangles into tiles
+	double raster = 0;	//clearing and filling the tiles
+	double shade = 0;	//resolving the visibility buffer, summed across the tiles so it can be more than raster, 0 when shading is part of raster
+	double present = 0;	//copying the framebuffer to the screen
+	double lines = 0;	//clipping and drawing debug lines
+	double ui = 0;		//wireframes, texts and the stats overlay
+};
+
+//what each stage of the last frame let through, the triangle counts are at the level of detail that was drawn
+struct RenderCounters {
+	int meshes = 0;
+	int meshesCulled = 0;		//outside the frustum
+	int meshesOccluded = 0;		//behind occluders
+	int trianglesTotal = 0;		//in every mesh at full detail
+	int trianglesCulled = 0;	//in meshes outside the frustum, at full detail
+	int trianglesSubmitted = 0;	//in the meshes that passed frustum culling
+	int trianglesOccluded = 0;
+	int trianglesBackFacing = 0;
+	int trianglesClipped = 0;	//cut by the near plane or the guard band
+	int trianglesOffscreen = 0;
+	int trianglesRasterized = 0; //queued for the rasterizer, clipped polygons count once per triangle they fan into
+	uint32 pixelsWritten = 0;	//depth test passes
+	uint32 pixelsShaded = 0;
+	uint32 pixelsCovered = 0;
+	uint32 pixelsHizRejected = 0;
+	int linesDrawn = 0;
+	bool reused = false; //nothing changed since the last frame so its framebuffer was shown again, the counts are that frame's
+
+	//one line per stage with its time and counts, for the r_stats command
+	std::string str(const RenderTimings& timings) const;
+};
+
+//what a frame's framebuffer was drawn from, a packet with the same key as the last drawn frame is shown without drawing it again
+struct FrameKey {
+	struct MeshKey {
+		Mesh* mesh;
+		uint32 version;
+		Texture* texture;
+		Matrix4 model;
+		uint32 lodLevel;
+		bool occluder;
+	};
+
+	Matrix4 view;
+	Matrix4 projection;
+	int32 width = 0;
+	int32 height = 0;
+	uint8 flags = 0; //the packet's toggles that change the framebuffer
+	Light* light = nullptr;
+	Vector3 lightDirection;
+	int32 shadowResolution = 0;
+	std::vector<MeshKey> meshes;	//drawn
+	std::vector<MeshKey> casters;	//shadow casters, in view or not
+	bool valid = false;
+};
+
+//everything a frame's rendering reads, copied from the scene on the main thread by Extract so the render thread
+//can draw it while the main thread moves on to simulating the next frame
+struct RenderPacket {
+	Camera camera;
+	Screen screen = Screen(0, 0);
+	Screen renderScreen = Screen(0, 0); //screen scaled by the dynamic resolution, the size the triangles are rasterized at
+	std::vector<MeshInstance> meshes; //the meshes that passed frustum culling
+	bool textures = false;
+	bool boundingBoxes = false;
+	bool occlusionCulling = false;
+	bool visibilityBuffer = false;
+
+	//the light that shadows the scene and its map's inputs, light is null when there are no shadows
+	Light* light = nullptr; //only its shadowMap is touched, which nothing else does
+	Vector3 lightPosition;
+	Vector3 lightDirection;
+	int32 shadowResolution = 0;
+	uint8 shadowUpdate = 0;
+	std::vector<Mesh*> casters;
+	std::vector<Matrix4> casterModels;
+
+	//drawn over the frame when its presented
+	DebugDraw debug;
+	std::vector<std::pair<Vector2, std::string>> texts;
+	std::vector<std::pair<Vector2, Vector2>> screenBoxes; //each mesh's screen rect (position, size), filled while rendering
+
+	bool reused = false;	//the framebuffer already holds this packet's frame, so Render skips drawing it
+	bool rendered = false; //a frame is waiting to be presented
+};
 
 struct RenderSceneSystem : public System {
+	ThreadPool pool;
+	VertexStage vertexStage;
+	Rasterizer rasterizer;
+	OcclusionBuffer occlusion;
+	RenderPacket packet;
+	RenderTimings timings;			//of the last presented frame
+	RenderTimings frameTimings;		//filled in while the packet is extracted and rendered, copied to timings once its done
+	RenderCounters counters;		//of the last presented frame
+	RenderCounters frameCounters;	//same as frameTimings
+	RenderCounters drawnCounters;	//of the last frame that wasnt reused, only touched by Render
+
+	//the last frame drawn into the framebuffer and a scratch key for the next packet, both only touched by Extract
+	FrameKey drawnKey;
+	FrameKey nextKey;
+
+	//while frames are being reused the main loop is slowed to IDLE_FRAME_MS, see Scene::IDLE_THROTTLE
+	static const uint32 IDLE_FRAMES = 10; //reused frames in a row before throttling
+	static const uint32 IDLE_FRAME_MS = 33;
+	uint32 idleFrames = 0;
+	steady_clock::time_point lastFrame;
+	Light* defaultLight = nullptr; //TODO replace this with light components on entities
+
+	//the scale of the screen the scene is rasterized at while Scene::DYNAMIC_RESOLUTION is on
+	DynamicResolution resolution;
+	bool resolutionEnabled = false; //Scene::DYNAMIC_RESOLUTION last frame, it starts over at full scale when turned on
+
+	//pipelined mode, toggled with Scene::RENDER_THREADED
+	//the render thread draws the packet while the main thread simulates the next frame, which then presents it
+	std::thread thread;
+	std::atomic<bool> threadRunning{false};
+	std::mutex frameMutex;
+	std::condition_variable frameQueued;
+	std::condition_variable frameDone;
+	bool framePending = false; //guarded by frameMutex
+
 	void Init() override;
 	void Update() override;
+
+	//copies what this frame renders into the packet, culling meshes and picking their levels of detail on the way
+	void Extract();
+	//draws the packet into the scene's framebuffer, on the render thread when its running
+	void Render();
+	//copies the framebuffer to the screen and draws the packet's lines, overlays and stats over it
+	void Present();
+	void UpdateResolution();
+
+	void StartThread();
+	void StopThread();
+	void ThreadLoop();
+	//blocks until the render thread has finished the last packet it was given
+	void WaitForFrame();
+
+	~RenderSceneSystem();
 };
\ No newline at end of file
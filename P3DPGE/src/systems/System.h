@@ -8,5 +8,6 @@ struct System {
 	virtual void Init() {}
 	virtual void Update() = 0;
 	virtual double Duration() { return time; }
+	virtual ~System() {}
 	//virtual void NotifyComponent(Component*) = 0;
 };
\ No newline at end of file
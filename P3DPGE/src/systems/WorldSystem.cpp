@@ -1,10 +1,12 @@
 #include "WorldSystem.h"
 #include "../EntityAdmin.h"
 #include "../utils/Debug.h"
+#include "../utils/PhysicsWorld.h"
 
 #include "../components/World.h"
 #include "../components/Transform.h"
 #include "../components/Mesh.h"
+#include "RenderSceneSystem.h"
 
 void WorldSystem::Init() {
 	
@@ -13,6 +15,21 @@ void WorldSystem::Init() {
 void WorldSystem::Update() {
 	World* world = admin->world;
 
+	//the physics thread reads the entities while it ticks, so only wait on it when something actually changes
+	std::unique_lock<std::mutex> lock(admin->physicsWorld->tickMutex, std::defer_lock);
+	if(!world->deletionBuffer.empty() || !world->creationBuffer.empty()) {
+		lock.lock();
+		++admin->physicsWorld->generation;
+	}
+
+	//the frame queued for the render thread points at the meshes, so let it finish before any are deleted
+	//not every admin has a renderer (eg. the physics benchmark), so dont assert on it
+	if(!world->deletionBuffer.empty()) {
+		for(System* s : admin->systems) {
+			if(RenderSceneSystem* render = dynamic_cast<RenderSceneSystem*>(s)) { render->WaitForFrame(); }
+		}
+	}
+
 	//deletion buffer
 	for(Entity* entity : world->deletionBuffer) {
 		uint32 id = entity->id;
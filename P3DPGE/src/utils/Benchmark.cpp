@@ -0,0 +1,576 @@
+#include "Benchmark.h"
+#include "PhysicsWorld.h"
+#include "../EntityAdmin.h"
+
+#include "../systems/PhysicsSystem.h"
+#include "../systems/WorldSystem.h"
+#include "../systems/CameraSystem.h"
+#include "../systems/RenderSceneSystem.h"
+
+#include "../components/Time.h"
+#include "../components/World.h"
+#include "../components/Transform.h"
+#include "../components/Physics.h"
+#include "../components/Collider.h"
+#include "../components/Camera.h"
+#include "../components/Screen.h"
+#include "../components/Scene.h"
+#include "../components/Mesh.h"
+
+#include "../math/Math.h"
+#include "../render/Texture.h"
+
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <sstream>
+
+//// Allocation Counting ////
+
+#ifdef BENCHMARK_ALLOCATIONS
+//replaces the global allocator so benchmarks can report how many allocations a run made
+//the counter is relaxed since we only ever read it between runs on the main thread
+static std::atomic<uint64> allocationCount(0);
+
+void* operator new(size_t size) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	if(size == 0) { size = 1; }
+	if(void* ptr = std::malloc(size)) { return ptr; }
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	std::free(ptr);
+}
+
+//the sized deletes would otherwise go to the default ones, which dont have to forward to the replacements above
+void operator delete(void* ptr, size_t size) noexcept {
+	(void)size;
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t size) noexcept {
+	(void)size;
+	std::free(ptr);
+}
+
+bool Benchmark::CountsAllocations() {
+	return true;
+}
+
+uint64 Benchmark::AllocationCount() {
+	return allocationCount.load(std::memory_order_relaxed);
+}
+#else
+bool Benchmark::CountsAllocations() {
+	return false;
+}
+
+uint64 Benchmark::AllocationCount() {
+	return 0;
+}
+#endif //BENCHMARK_ALLOCATIONS
+
+//// Physics ////
+
+//small lcg so every run of a scene is laid out exactly the same
+inline float BenchRandom(uint32& seed, float min, float max) {
+	seed = seed * 1664525u + 1013904223u;
+	return min + (max - min) * ((seed >> 8) / float(1 << 24));
+}
+
+//adds a body to the scratch admin's creation buffer, type 0 is an aabb, 1 a sphere, 2 a box, 3 a trigger aabb, 4 no collider
+inline void AddBenchBody(EntityAdmin* admin, int type, Vector3 position, Vector3 halfDims, float mass = 1.f, bool isStatic = false) {
+	Entity* e = WorldSystem::CreateEntity(admin);
+	Transform* t = new Transform(position, Vector3::ZERO, Vector3::ONE);
+	Physics* p = new Physics(position, Vector3::ZERO, Vector3::ZERO, Vector3::ZERO, Vector3::ZERO, Vector3::ZERO, .5f, mass, isStatic);
+	Collider* c = nullptr;
+	switch(type) {
+		case 0: c = new AABBCollider(e, halfDims, mass); break;
+		case 1: c = new SphereCollider(e, halfDims.x, mass); break;
+		case 2: c = new BoxCollider(e, halfDims, mass); break;
+		case 3: c = new AABBCollider(e, halfDims, mass, true, nullptr); break;
+	}
+	if(c) {
+		WorldSystem::AddComponentsToEntity(e, { t, p, c });
+	} else {
+		WorldSystem::AddComponentsToEntity(e, { t, p });
+	}
+}
+
+inline void AddBenchFloor(EntityAdmin* admin) {
+	AddBenchBody(admin, 0, Vector3(0, -1, 0), Vector3(50, 1, 50), 1000.f, true);
+}
+
+//columns of boxes stacked on top of each other on a floor
+void BuildBoxPile(EntityAdmin* admin) {
+	AddBenchFloor(admin);
+	for(int x = 0; x < 5; ++x) {
+		for(int z = 0; z < 5; ++z) {
+			for(int y = 0; y < 4; ++y) {
+				AddBenchBody(admin, 0, Vector3(x * 1.1f, .5f + y * 1.05f, z * 1.1f), Vector3(.5f, .5f, .5f));
+			}
+		}
+	}
+}
+
+//spheres dropped from random heights onto a floor
+void BuildSphereRain(EntityAdmin* admin) {
+	AddBenchFloor(admin);
+	uint32 seed = 1;
+	for(int i = 0; i < 150; ++i) {
+		Vector3 position(BenchRandom(seed, -20, 20), BenchRandom(seed, 2, 40), BenchRandom(seed, -20, 20));
+		AddBenchBody(admin, 1, position, Vector3(.5f, .5f, .5f));
+	}
+}
+
+//a 100x100 grid of static tiles with a few boxes falling on it, mostly measures the broadphase
+void BuildFloorTiles(EntityAdmin* admin) {
+	for(int x = 0; x < 100; ++x) {
+		for(int z = 0; z < 100; ++z) {
+			AddBenchBody(admin, 0, Vector3(x - 50.f, -.1f, z - 50.f), Vector3(.5f, .1f, .5f), 1000.f, true);
+		}
+	}
+	for(int i = 0; i < 16; ++i) {
+		AddBenchBody(admin, 0, Vector3((i % 4) * 3.f, 3, (i / 4) * 3.f), Vector3(.5f, .5f, .5f));
+	}
+}
+
+//every collider type, triggers and bodies without colliders mixed together
+void BuildColliderZoo(EntityAdmin* admin) {
+	AddBenchFloor(admin);
+	uint32 seed = 7;
+	for(int i = 0; i < 150; ++i) {
+		Vector3 position(BenchRandom(seed, -10, 10), BenchRandom(seed, 1, 20), BenchRandom(seed, -10, 10));
+		AddBenchBody(admin, i % 5, position, Vector3(.5f, .5f, .5f), BenchRandom(seed, .5f, 3.f));
+	}
+}
+
+//runs a single scene on a scratch admin that only has the world and physics systems, no window or renderer
+std::string RunPhysicsScene(const char* name, void (*build)(EntityAdmin*), uint32 ticks) {
+	EntityAdmin bench = EntityAdmin();
+	bench.physicsWorld = new PhysicsWorld();
+	bench.time = new Time();
+	bench.world = new World();
+	bench.AddSystem(new WorldSystem());
+	bench.AddSystem(new PhysicsSystem());
+
+	build(&bench);
+	bench.GetSystem<WorldSystem>()->Update(); //flush the creation buffer
+	PhysicsSystem* physics = bench.GetSystem<PhysicsSystem>();
+
+	//one fixed step per update so the tick count is exact
+	uint64 allocations = Benchmark::AllocationCount();
+	steady_clock::time_point start = steady_clock::now();
+	for(uint32 i = 0; i < ticks; ++i) {
+		bench.time->physicsAccumulator += bench.time->physicsDeltaTime;
+		physics->Update();
+	}
+	double seconds = duration_cast<duration<double>>(steady_clock::now() - start).count();
+	allocations = Benchmark::AllocationCount() - allocations;
+
+	std::stringstream out;
+	out << "\t\t{ \"name\": \"" << name << "\""
+		<< ", \"entities\": " << bench.entities.size()
+		<< ", \"ticks\": " << ticks
+		<< ", \"seconds\": " << seconds
+		<< ", \"ticks_per_second\": " << (seconds > 0 ? ticks / seconds : 0)
+		<< ", \"pairs_tested\": " << bench.physicsWorld->pairsTested
+		<< ", \"contacts_resolved\": " << bench.physicsWorld->contactsResolved;
+	if(Benchmark::CountsAllocations()) { out << ", \"allocations\": " << allocations; }
+	out << " }";
+
+	bench.Cleanup();
+	return out.str();
+}
+
+//each scene runs for its own fixed number of ticks, picked so every scene takes long enough to time
+struct PhysicsBenchScene {
+	const char* name;
+	void (*build)(EntityAdmin*);
+	uint32 ticks;
+};
+
+static const PhysicsBenchScene physicsBenchScenes[] = {
+	{ "box_pile",		BuildBoxPile,		600 },
+	{ "sphere_rain",	BuildSphereRain,	600 },
+	{ "floor_tiles",	BuildFloorTiles,	1 },	//10k bodies test ~100M pairs a tick, a single tick already takes tens of seconds
+	{ "collider_zoo",	BuildColliderZoo,	600 },
+};
+
+std::string Benchmark::Physics(uint32 repeat) {
+	if(repeat == 0) { repeat = 1; }
+
+	//logging in the collision functions would dominate the timings
+	bool debug = GLOBAL_DEBUG;
+	GLOBAL_DEBUG = false;
+
+	std::stringstream out;
+	out << "{\n\t\"benchmark\": \"physics\",\n\t\"physics_timestep\": " << Time().physicsTimeStep
+		<< ",\n\t\"repeat\": " << repeat << ",\n\t\"scenes\": [\n";
+	const int sceneCount = sizeof(physicsBenchScenes) / sizeof(physicsBenchScenes[0]);
+	for(int i = 0; i < sceneCount; ++i) {
+		const PhysicsBenchScene& scene = physicsBenchScenes[i];
+		out << RunPhysicsScene(scene.name, scene.build, scene.ticks * repeat) << ((i + 1 < sceneCount) ? ",\n" : "\n");
+	}
+	out << "\t]\n}";
+
+	GLOBAL_DEBUG = debug;
+	return out.str();
+}
+
+//// Render ////
+
+//hash of the golden frame at 1280x720, a change that is meant to alter the rendered image has to update it
+//produced by the headless build (CMakeLists.txt) with gcc 12.2 -O2 -ffp-contract=off on x86-64 linux, the SSE2 and AVX2 kernels give the same hash
+//its only bit exact where floats round the same way: no fused multiply-adds and the same libm sinf/cosf/tanf,
+//so a mismatch on another compiler or cpu has to be checked against the image saved with imagePath before the hash is changed
+static const uint32 RENDER_GOLDEN_HASH = 13997038;
+static const int32 RENDER_GOLDEN_WIDTH = 1280;
+static const int32 RENDER_GOLDEN_HEIGHT = 720;
+
+std::string Benchmark::Render(uint32 frames, int32 width, int32 height, const std::string& imagePath, bool* passed) {
+	if(frames == 0) { frames = 1; }
+
+	//a scratch admin with no PixelGameEngine, RenderSceneSystem leaves each frame in the scene's framebuffer
+	EntityAdmin bench = EntityAdmin();
+	bench.p = nullptr;
+	bench.physicsWorld = new PhysicsWorld();
+	bench.time = new Time();
+	bench.world = new World();
+	bench.screen = new Screen(width, height);
+	bench.currentCamera = new Camera();
+	bench.currentScene = new Scene(width, height);
+	bench.AddSystem(new WorldSystem());
+	bench.AddSystem(new CameraSystem());
+	bench.AddSystem(new RenderSceneSystem());
+
+	Scene* scene = bench.currentScene;
+	scene->RENDER_TEXTURES = true;
+	scene->RENDER_LOCAL_AXIS = false;
+	scene->RENDER_PHYSICS = false;
+	scene->RENDER_SHADOWS = true; //nothing moves, so the shadow map is only rendered on the first frame
+	scene->DYNAMIC_RESOLUTION = false; //the golden frame has to be rasterized at full resolution
+
+	//a checkerboard made in memory so the benchmark doesnt depend on files next to the executable
+	olc::Sprite checker(256, 256);
+	for(int32 y = 0; y < 256; ++y) {
+		for(int32 x = 0; x < 256; ++x) {
+			checker.SetPixel(x, y, ((x / 32 + y / 32) % 2) ? olc::Pixel(230, 230, 230) : olc::Pixel(40, 90, 160));
+		}
+	}
+	Texture* texture = new Texture(&checker);
+
+	//a 16x16 field of boxes with varying sizes and rotations
+	uint32 seed = 3;
+	int32 triangles = 0;
+	for(int32 x = 0; x < 16; ++x) {
+		for(int32 z = 0; z < 16; ++z) {
+			Entity* e = WorldSystem::CreateEntity(&bench);
+			Vector3 position((x - 7.5f) * 3.f, BenchRandom(seed, 0, 2), (z - 7.5f) * 3.f);
+			Transform* t = new Transform(position, Vector3(BenchRandom(seed, 0, 90), BenchRandom(seed, 0, 90), 0), Vector3::ONE);
+			float size = BenchRandom(seed, .5f, 1.4f);
+			Mesh* m = Mesh::CreateBox(e, Vector3(size, size, size), position, texture);
+			triangles += m->triangles.size();
+			WorldSystem::AddComponentsToEntity(e, { t, m });
+		}
+	}
+
+	//a wall across the middle of the field, marked as an occluder so the boxes behind it exercise occlusion culling
+	{
+		Entity* e = WorldSystem::CreateEntity(&bench);
+		Vector3 position(0, 2.5f, 0);
+		Transform* t = new Transform(position, Vector3::ZERO, Vector3::ONE);
+		Mesh* m = Mesh::CreateBox(e, Vector3(26, 2.5f, .5f), position, texture);
+		m->occluder = true;
+		triangles += m->triangles.size();
+		WorldSystem::AddComponentsToEntity(e, { t, m });
+	}
+	bench.GetSystem<WorldSystem>()->Update(); //flush the creation buffer
+
+	CameraSystem* cameraSystem = bench.GetSystem<CameraSystem>();
+	RenderSceneSystem* render = bench.GetSystem<RenderSceneSystem>();
+	Camera* camera = bench.currentCamera;
+
+	//sums over one sweep of the camera
+	struct SweepTotals {
+		RenderTimings timings;
+		double frameSeconds = 0;
+		long long occludedMeshes = 0;
+		long long writtenPixels = 0;
+		long long shadedPixels = 0;
+		long long coveredPixels = 0;
+	};
+	//sweeps side to side in front of the field and dollies into it and back, looking down at it along +z
+	//target is (radius, yaw, pitch) in degrees like the camera controls use
+	auto placeCamera = [&](float angle) {
+		camera->position = Vector3(15.f * sinf(angle), 12.f, -30.f + 10.f * (1.f - cosf(angle)));
+		camera->target = Vector3(1, 90, 70);
+	};
+	auto sweep = [&](SweepTotals& total) {
+		for(uint32 i = 0; i < frames; ++i) {
+			placeCamera(2.f * M_PI * i / frames);
+
+			steady_clock::time_point start = steady_clock::now();
+			cameraSystem->Update();
+			render->Update();
+			total.frameSeconds += duration_cast<duration<double>>(steady_clock::now() - start).count();
+
+			const RenderTimings& t = render->timings;
+			RenderTimings& sum = total.timings;
+			sum.gather += t.gather; sum.shadow += t.shadow; sum.cull += t.cull; sum.vertex += t.vertex; sum.occlusion += t.occlusion;
+			sum.setup += t.setup; sum.bin += t.bin; sum.raster += t.raster; sum.shade += t.shade;
+			total.occludedMeshes += render->occlusion.occludedMeshes;
+			total.writtenPixels += render->rasterizer.writtenPixels;
+			total.shadedPixels += render->rasterizer.shadedPixels;
+			total.coveredPixels += render->rasterizer.coveredPixels;
+		}
+	};
+
+	//the same sweep again with the visibility buffer, its last frame has to come out the same
+	SweepTotals total;
+	sweep(total);
+	uint32 forwardHash = scene->framebuffer.Hash();
+	SweepTotals visibility;
+	scene->VISIBILITY_BUFFER = true;
+	sweep(visibility);
+	uint32 visibilityHash = scene->framebuffer.Hash();
+	scene->VISIBILITY_BUFFER = false;
+
+	//the golden frame is taken from where the sweep starts so it doesnt depend on the frame count
+	bool golden = width == RENDER_GOLDEN_WIDTH && height == RENDER_GOLDEN_HEIGHT;
+	uint32 goldenHash = 0;
+	if(golden) {
+		placeCamera(0);
+		cameraSystem->Update();
+		render->Update();
+		goldenHash = scene->framebuffer.Hash();
+	}
+	if(passed) { *passed = (visibilityHash == forwardHash) && (!golden || goldenHash == RENDER_GOLDEN_HASH); }
+
+	bool saved = false;
+	if(!imagePath.empty()) {
+		bool png = imagePath.size() >= 4 && imagePath.compare(imagePath.size() - 4, 4, ".png") == 0;
+		saved = png ? scene->framebuffer.SavePNG(imagePath) : scene->framebuffer.SavePPM(imagePath);
+	}
+
+	std::stringstream out;
+	out << "{\n\t\"benchmark\": \"render\",\n"
+		<< "\t\"frames\": " << frames << ", \"width\": " << width << ", \"height\": " << height
+		<< ", \"meshes\": " << scene->meshes.size() << ", \"triangles\": " << triangles << ",\n"
+		<< "\t\"ms_per_frame\": { \"total\": " << 1000. * total.frameSeconds / frames
+		<< ", \"gather\": " << total.timings.gather / frames
+		<< ", \"shadow\": " << total.timings.shadow / frames
+		<< ", \"cull\": " << total.timings.cull / frames
+		<< ", \"vertex\": " << total.timings.vertex / frames
+		<< ", \"occlusion\": " << total.timings.occlusion / frames
+		<< ", \"setup\": " << total.timings.setup / frames
+		<< ", \"bin\": " << total.timings.bin / frames
+		<< ", \"raster\": " << total.timings.raster / frames << " },\n"
+		<< "\t\"occluded_meshes_per_frame\": " << (double)total.occludedMeshes / frames << ",\n"
+		<< "\t\"overdraw\": " << (total.coveredPixels ? (double)total.writtenPixels / total.coveredPixels : 0.)
+		<< ", \"shaded_pixels_per_frame\": " << (double)total.shadedPixels / frames << ",\n"
+		<< "\t\"visibility_buffer\": { \"ms_total\": " << 1000. * visibility.frameSeconds / frames
+		<< ", \"ms_raster\": " << visibility.timings.raster / frames
+		<< ", \"ms_shade\": " << visibility.timings.shade / frames
+		<< ", \"shaded_pixels_per_frame\": " << (double)visibility.shadedPixels / frames
+		<< ", \"matches\": " << ((visibilityHash == forwardHash) ? "true" : "false") << " },\n"
+		<< "\t\"last_frame_hash\": " << forwardHash << ",\n";
+	if(golden) {
+		out << "\t\"golden\": { \"hash\": " << goldenHash << ", \"expected\": " << RENDER_GOLDEN_HASH
+			<< ", \"matches\": " << ((goldenHash == RENDER_GOLDEN_HASH) ? "true" : "false") << " }";
+	} else {
+		out << "\t\"golden\": null"; //only checked at RENDER_GOLDEN_WIDTH x RENDER_GOLDEN_HEIGHT
+	}
+	if(!imagePath.empty()) {
+		out << ",\n\t\"image\": \"" << imagePath << "\", \"image_saved\": " << (saved ? "true" : "false");
+	}
+	out << "\n}";
+
+	bench.Cleanup();
+	delete texture;
+	return out.str();
+}
+
+//// Back-Face ////
+
+std::string Benchmark::BackFace(uint32 iterations) {
+	if(iterations == 0) { iterations = 1; }
+
+	//a bumpy sphere so every view has triangles facing both ways, some of them nearly edge on
+	const int32 rings = 128;
+	const int32 segments = 256;
+	std::vector<Vector3> vertices;
+	std::vector<uint32> indices;
+	uint32 seed = 7;
+	for(int32 r = 0; r <= rings; ++r) {
+		float theta = M_PI * r / rings;
+		for(int32 s = 0; s < segments; ++s) {
+			float phi = 2.f * M_PI * s / segments;
+			float radius = BenchRandom(seed, .9f, 1.1f);
+			vertices.push_back(Vector3(radius * sinf(theta) * cosf(phi), radius * cosf(theta), radius * sinf(theta) * sinf(phi)));
+		}
+	}
+	for(int32 r = 0; r < rings; ++r) {
+		for(int32 s = 0; s < segments; ++s) {
+			uint32 a = r * segments + s;
+			uint32 b = r * segments + (s + 1) % segments;
+			uint32 c = a + segments;
+			uint32 d = b + segments;
+			indices.insert(indices.end(), { a, c, b, b, c, d });
+		}
+	}
+	std::vector<FacePlane> planes;
+	Mesh::BuildFacePlanes(vertices, indices, planes);
+	uint32 triangles = (uint32)planes.size();
+
+	//a ring of cameras around the mesh, each looking at it with the same view matrix the camera system makes
+	const int32 views = 8;
+	std::vector<Matrix4> modelViews;
+	for(int32 i = 0; i < views; ++i) {
+		float angle = 2.f * M_PI * i / views;
+		Vector3 position(4.f * cosf(angle), 1.5f * sinf(3.f * angle), 4.f * sinf(angle));
+		Vector3 up = Vector3::UP;
+		Matrix4 model = Matrix4::TransformationMatrix(Vector3(0, .5f, 0), Vector3(15.f * i, 40.f, 0), Vector3::ONE);
+		modelViews.push_back(model * Math::LookAtMatrix(position, Vector3::ZERO, up).Inverse());
+	}
+
+	//before: the vertex stage's view space positions and a cross product per triangle, with the winding flipped for mirrored views
+	//the view space positions come from the vertex stage either way so theyre made outside the timing
+	std::vector<std::vector<Vector3>> viewVertices(views);
+	for(int32 i = 0; i < views; ++i) {
+		for(const Vector3& v : vertices) { viewVertices[i].push_back(v * modelViews[i]); }
+	}
+	std::vector<uint8> crossFacing(views * triangles);
+	long long crossVisible = 0;
+	steady_clock::time_point start = steady_clock::now();
+	for(uint32 n = 0; n < iterations; ++n) {
+		for(int32 i = 0; i < views; ++i) {
+			const std::vector<Vector3>& c = viewVertices[i];
+			float facing = (modelViews[i].Determinant() < 0) ? -1.f : 1.f;
+			for(uint32 t = 0; t < triangles; ++t) {
+				const Vector3& v0 = c[indices[3 * t]];
+				Vector3 normal = (c[indices[3 * t + 1]] - v0).trueCross(c[indices[3 * t + 2]] - v0);
+				bool visible = facing * normal.dot(v0) < 0;
+				crossFacing[i * triangles + t] = visible;
+				crossVisible += visible;
+			}
+		}
+	}
+	double crossSeconds = duration_cast<duration<double>>(steady_clock::now() - start).count();
+
+	//after: the camera moved into the mesh's local space once, then a dot product against each cached plane
+	std::vector<uint8> planeFacing(views * triangles);
+	long long planeVisible = 0;
+	start = steady_clock::now();
+	for(uint32 n = 0; n < iterations; ++n) {
+		for(int32 i = 0; i < views; ++i) {
+			Vector3 eye = VertexStage::LocalEye(modelViews[i]);
+			for(uint32 t = 0; t < triangles; ++t) {
+				bool visible = planes[t].normal.dot(eye) > planes[t].offset;
+				planeFacing[i * triangles + t] = visible;
+				planeVisible += visible;
+			}
+		}
+	}
+	double planeSeconds = duration_cast<duration<double>>(steady_clock::now() - start).count();
+
+	//edge on triangles can land on either side from rounding, anything more means the tests disagree
+	uint32 mismatches = 0;
+	for(size_t i = 0; i < crossFacing.size(); ++i) { mismatches += crossFacing[i] != planeFacing[i]; }
+
+	double tests = (double)iterations * views * triangles;
+	std::stringstream out;
+	out << "{\n\t\"benchmark\": \"backface\",\n"
+		<< "\t\"iterations\": " << iterations << ", \"views\": " << views << ", \"triangles\": " << triangles << ",\n"
+		<< "\t\"view_space_cross\": { \"ns_per_triangle\": " << 1e9 * crossSeconds / tests
+		<< ", \"visible_per_view\": " << (double)crossVisible / (iterations * views) << " },\n"
+		<< "\t\"cached_plane\": { \"ns_per_triangle\": " << 1e9 * planeSeconds / tests
+		<< ", \"visible_per_view\": " << (double)planeVisible / (iterations * views) << " },\n"
+		<< "\t\"speedup\": " << (planeSeconds > 0 ? crossSeconds / planeSeconds : 0)
+		<< ", \"mismatched_triangles\": " << mismatches << "\n}";
+	return out.str();
+}
+
+//// Sampler ////
+
+std::string Benchmark::Sampler(uint32 passes) {
+	if(passes == 0) { passes = 1; }
+
+	//smooth gradients with noise like a photo, crossed by a grid of flat lines like a uv grid
+	const int32 size = 512;
+	olc::Sprite sprite(size, size);
+	uint32 seed = 11;
+	for(int32 y = 0; y < size; ++y) {
+		for(int32 x = 0; x < size; ++x) {
+			float noise = BenchRandom(seed, -12.f, 12.f);
+			uint8 r = (uint8)std::max(0.f, std::min(255.f, 255.f * x / size + noise));
+			uint8 g = (uint8)std::max(0.f, std::min(255.f, 127.5f + 127.5f * sinf(y * .05f) + noise));
+			uint8 b = (uint8)std::max(0.f, std::min(255.f, 255.f * (size - y) / size + noise));
+			bool line = (x % 64) < 2 || (y % 64) < 2;
+			sprite.SetPixel(x, y, line ? olc::Pixel(20, 20, 20) : olc::Pixel(r, g, b));
+		}
+	}
+
+	//a 640x480 screen mapped onto the texture at about a texel per pixel, shifted each pass
+	const int32 screenWidth = 640;
+	const int32 screenHeight = 480;
+	double samples = (double)passes * screenWidth * screenHeight;
+
+	std::stringstream out;
+	out << "{\n\t\"benchmark\": \"sampler\",\n\t\"texture_size\": " << size << ", \"passes\": " << passes
+		<< ", \"samples_per_pass\": " << screenWidth * screenHeight << ",\n\t\"formats\": [\n";
+	Texture reference(&sprite, Texture::FILTER_BILINEAR, Texture::FORMAT_RGBA32);
+	uint32 sink = 0;
+	for(int32 f = 0; f < Texture::FORMAT_COUNT; ++f) {
+		Texture::Format format = (Texture::Format)f;
+		steady_clock::time_point start = steady_clock::now();
+		Texture texture(&sprite, Texture::FILTER_BILINEAR, format);
+		double loadMS = duration_cast<duration<double, std::milli>>(steady_clock::now() - start).count();
+
+		//mean absolute difference per channel at every full size texel
+		double error = 0;
+		for(int32 y = 0; y < size; ++y) {
+			for(int32 x = 0; x < size; ++x) {
+				float u = (x + .5f) / size, v = (y + .5f) / size;
+				olc::Pixel a(texture.SampleNearest(0, u, v)), b(reference.SampleNearest(0, u, v));
+				error += abs(a.r - b.r) + abs(a.g - b.g) + abs(a.b - b.b);
+			}
+		}
+		error /= 3. * size * size;
+
+		double seconds[2];
+		for(int32 bilinear = 0; bilinear < 2; ++bilinear) {
+			start = steady_clock::now();
+			for(uint32 pass = 0; pass < passes; ++pass) {
+				float offsetU = .37f * pass, offsetV = .61f * pass;
+				for(int32 y = 0; y < screenHeight; ++y) {
+					float v = offsetV + (y + .5f) / size;
+					for(int32 x = 0; x < screenWidth; ++x) {
+						float u = offsetU + (x + .5f) / size;
+						sink ^= bilinear ? texture.SampleBilinear(0, u, v) : texture.SampleNearest(0, u, v);
+					}
+				}
+			}
+			seconds[bilinear] = duration_cast<duration<double>>(steady_clock::now() - start).count();
+		}
+
+		out << "\t\t{ \"format\": \"" << Texture::FormatName(format) << "\""
+			<< ", \"bytes\": " << texture.Bytes()
+			<< ", \"load_ms\": " << loadMS
+			<< ", \"mean_error\": " << error
+			<< ", \"nearest_msamples_per_second\": " << (seconds[0] > 0 ? samples / seconds[0] / 1e6 : 0)
+			<< ", \"bilinear_msamples_per_second\": " << (seconds[1] > 0 ? samples / seconds[1] / 1e6 : 0) << " }"
+			<< ((f + 1 < Texture::FORMAT_COUNT) ? ",\n" : "\n");
+	}
+	out << "\t],\n\t\"checksum\": " << sink << "\n}";
+	return out.str();
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "UsefulDefines.h"
+
+#include <string>
+
+//headless benchmarks that build a scratch EntityAdmin with only the systems they measure,
+//so they can be run from the console or with a command line flag without opening a window
+//results are returned as JSON so they can be diffed across commits
+namespace Benchmark {
+	//counting allocations replaces the global operator new for the whole program, so its only compiled in
+	//when BENCHMARK_ALLOCATIONS is defined for a benchmark build, otherwise allocations are left out of the results
+	bool CountsAllocations();
+	//number of calls to global operator new since the program started, 0 when allocations arent counted
+	uint64 AllocationCount();
+
+	//runs the canned physics scenes (box pile, sphere rain, floor tiles, collider zoo)
+	//for their own fixed number of ticks each, repeat times over, and records each scene's tick count
+	std::string Physics(uint32 repeat = 1);
+
+	//renders a field of textured boxes headless while the camera sweeps across it over the frames,
+	//reporting ms per frame for each render stage, the overdraw and a hash of the last frame to compare against a known good one
+	//the sweep is run again with the visibility buffer to compare its shading cost, and its last frame has to match
+	//at 1280x720 a golden frame from a fixed camera is rendered as well and compared against a stored hash
+	//passed is set to false when either check fails, so -bench_render can fail a CI run on a regression
+	//the last frame is also written to imagePath (.ppm or .png) when its not empty
+	std::string Render(uint32 frames = 120, int32 width = 1280, int32 height = 720, const std::string& imagePath = "", bool* passed = nullptr);
+
+	//times back-face culling a dense mesh from a ring of views, both the old test that crosses each triangle's
+	//view space edges and the one that checks the camera against the mesh's cached FacePlanes, and counts where they disagree
+	std::string BackFace(uint32 iterations = 100);
+
+	//samples a generated texture stored in each Texture::Format along scanlines like the rasterizer does, reporting
+	//millions of nearest and bilinear samples per second, the bytes each format takes and its mean error against rgba32
+	std::string Sampler(uint32 passes = 20);
+};
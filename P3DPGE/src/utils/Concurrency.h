@@ -0,0 +1,70 @@
+#pragma once
+#include "UsefulDefines.h"
+
+#include <atomic>
+
+//// SPSCQueue ////
+
+//fixed capacity lock-free ring buffer for exactly one producer thread and one consumer thread
+//capacity must be a power of two, one slot is kept empty to tell full from empty
+template<class T, uint32 capacity>
+struct SPSCQueue {
+	static_assert((capacity & (capacity - 1)) == 0, "SPSCQueue capacity must be a power of two");
+
+	T items[capacity];
+	std::atomic<uint32> head{0}; //next slot to read, only written by the consumer
+	std::atomic<uint32> tail{0}; //next slot to write, only written by the producer
+
+	//returns false if the queue is full and the item was dropped
+	bool Push(const T& item) {
+		uint32 t = tail.load(std::memory_order_relaxed);
+		uint32 next = (t + 1) & (capacity - 1);
+		if(next == head.load(std::memory_order_acquire)) { return false; }
+		items[t] = item;
+		tail.store(next, std::memory_order_release);
+		return true;
+	}
+
+	//returns false if the queue is empty
+	bool Pop(T& item) {
+		uint32 h = head.load(std::memory_order_relaxed);
+		if(h == tail.load(std::memory_order_acquire)) { return false; }
+		item = items[h];
+		head.store((h + 1) & (capacity - 1), std::memory_order_release);
+		return true;
+	}
+};
+
+//// TripleBuffer ////
+
+//lock-free single writer, single reader buffer: the writer fills its back buffer and publishes it,
+//the reader always grabs the newest published buffer. its a double buffer with a spare slot so
+//neither side ever has to wait for the other to finish with a buffer
+template<class T>
+struct TripleBuffer {
+	T buffers[3];
+	//index of the published middle buffer, with the 4 bit set when it hasnt been read yet
+	std::atomic<uint8> middle{1};
+	uint8 back  = 0; //only touched by the writer
+	uint8 front = 2; //only touched by the reader
+
+	static const uint8 FRESH_BIT = 4;
+
+	//the buffer the writer should fill before calling Publish()
+	T& Back() { return buffers[back]; }
+
+	//swaps the back buffer into the middle and marks it as fresh
+	void Publish() {
+		back = middle.exchange(back | FRESH_BIT, std::memory_order_acq_rel) & ~FRESH_BIT;
+	}
+
+	//swaps the newest published buffer to the front if there is one, returns true if it changed
+	bool Update() {
+		if(!(middle.load(std::memory_order_relaxed) & FRESH_BIT)) { return false; }
+		front = middle.exchange(front, std::memory_order_acq_rel) & ~FRESH_BIT;
+		return true;
+	}
+
+	//the buffer the reader should read from
+	T& Front() { return buffers[front]; }
+};
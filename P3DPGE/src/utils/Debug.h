@@ -9,7 +9,9 @@
 #include <vector>
 #include <cstdarg>
 #include <iostream>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 //global debug macros
 #define DEBUG if(GLOBAL_DEBUG)
@@ -153,15 +155,21 @@ namespace Debug {
 
 	//// Console Output ////
 
+#ifdef _WIN32
 	static HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+	static void SetConsoleColor(int color) { SetConsoleTextAttribute(hConsole, color); }
+#else
+	//only the windows console is colored, other terminals get plain text
+	static void SetConsoleColor(int color) {}
+#endif
 	static int color = 7;
 	static void ResetCmd() { //resets cmd font color to white
 		color = 7;
-		SetConsoleTextAttribute(hConsole, color);
+		SetConsoleColor(color);
 	}
 
 	static void Print(ConsoleColor color, const char* str, bool newline = true) {
-		SetConsoleTextAttribute(hConsole, color);
+		SetConsoleColor(color);
 		if (newline) { std::cout << str << std::endl; }
 		else { std::cout << str; }
 		ResetCmd();
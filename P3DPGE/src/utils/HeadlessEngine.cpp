@@ -0,0 +1,66 @@
+//stands in for the olcPixelGameEngine implementation in the headless build (CMakeLists.txt), which has no window
+//the parts of olc::Pixel and olc::Sprite the renderer uses work the same as the engine's, drawing to the screen does nothing
+//the windows build gets all of it from OLC_PGE_APPLICATION in main.cpp instead
+#ifdef P3DPGE_HEADLESS
+#include "../internal/olcPixelGameEngine.h"
+
+namespace olc {
+
+//// Pixel ////
+
+	Pixel::Pixel() { r = 0; g = 0; b = 0; a = nDefaultAlpha; }
+
+	Pixel::Pixel(uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha) {
+		n = red | (green << 8) | (blue << 16) | (alpha << 24);
+	}
+
+	Pixel::Pixel(uint32_t p) { n = p; }
+
+	Pixel Pixel::operator*(const float i) const {
+		float fR = std::min(255.0f, std::max(0.0f, float(r) * i));
+		float fG = std::min(255.0f, std::max(0.0f, float(g) * i));
+		float fB = std::min(255.0f, std::max(0.0f, float(b) * i));
+		return Pixel(uint8_t(fR), uint8_t(fG), uint8_t(fB), a);
+	}
+
+//// Sprite ////
+
+	//theres no image loader without a platform, so sprites loaded from files are empty
+	Sprite::Sprite(const std::string& sImageFile, olc::ResourcePack* pack) {}
+
+	Sprite::Sprite(int32_t w, int32_t h) {
+		width = w; height = h;
+		pColData = new Pixel[width * height];
+	}
+
+	Sprite::~Sprite() { delete[] pColData; }
+
+	Pixel Sprite::GetPixel(int32_t x, int32_t y) const {
+		if(modeSample == olc::Sprite::Mode::NORMAL) {
+			if(x >= 0 && x < width && y >= 0 && y < height) { return pColData[y * width + x]; }
+			return Pixel(0, 0, 0, 0);
+		}
+		return pColData[abs(y % height) * width + abs(x % width)];
+	}
+
+	bool Sprite::SetPixel(int32_t x, int32_t y, Pixel p) {
+		if(x < 0 || x >= width || y < 0 || y >= height) { return false; }
+		pColData[y * width + x] = p;
+		return true;
+	}
+
+	Pixel* Sprite::GetData() { return pColData; }
+
+//// PixelGameEngine ////
+
+	//the renderer only draws with these when it has an engine, which a headless admin never does
+	void PixelGameEngine::DrawCircle(const olc::vi2d& pos, int32_t radius, Pixel p, uint8_t mask) {}
+	void PixelGameEngine::DrawLine(const olc::vi2d& pos1, const olc::vi2d& pos2, Pixel p, uint32_t pattern) {}
+	void PixelGameEngine::DrawRect(const olc::vi2d& pos, const olc::vi2d& size, Pixel p) {}
+	void PixelGameEngine::DrawString(const olc::vi2d& pos, const std::string& sText, Pixel col, uint32_t scale) {}
+	void PixelGameEngine::DrawStringDecal(const olc::vf2d& pos, const std::string& sText, const Pixel col, const olc::vf2d& scale) {}
+	void PixelGameEngine::DrawTriangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p) {}
+	olc::Sprite* PixelGameEngine::GetDrawTarget() const { return nullptr; }
+	olc::vi2d PixelGameEngine::GetTextSize(const std::string& s) { return olc::vi2d(0, 0); }
+}
+#endif //P3DPGE_HEADLESS
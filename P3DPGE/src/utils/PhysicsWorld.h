@@ -1,4 +1,9 @@
 #pragma once
+#include "UsefulDefines.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
 //#include "../components/Transform.h"
 //#include "../components/Physics.h"
 //#include "../math/Math.h"
@@ -23,6 +28,8 @@ enum struct IntegrationMode {
 
 //TODO(p,delle) look into maybe having physics here instead
 
+struct Entity;
+
 struct PhysicsWorld {
 	//std::map<EntityID, PhysEntity> entityTuples;
 
@@ -38,6 +45,17 @@ struct PhysicsWorld {
 	float gravity		= 9.81f;
 	float frictionAir	= 0.01f; //TODO(p,delle) this should depend on object shape
 
+	//running totals for profiling, only ever incremented by PhysicsSystem
+	uint64 pairsTested		= 0;
+	uint64 contactsResolved	= 0;
+
+	//runs PhysicsSystem on its own thread at the fixed physicsTimeStep instead of in the frame loop
+	bool threaded = false;
+	std::atomic<bool> paused{false};	//mirrors EntityAdmin::paused and Time::paused for the physics thread
+	uint32 generation = 0;				//incremented whenever entities are created or deleted, tells the physics thread to rebuild
+	std::mutex tickMutex;				//held by the physics thread while it ticks and by the main thread while it changes entities
+	std::vector<Entity*> collisions;	//entities that collided this tick, only touched by whichever thread is ticking
+
 	PhysicsWorld() {
 		this->integrationMode	= IntegrationMode::EULER;
 		this->collisionMode		= CollisionDetectionMode::DISCRETE;
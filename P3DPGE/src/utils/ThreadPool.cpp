@@ -0,0 +1,78 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(uint32 threadCount) {
+	if(threadCount == 0) {
+		uint32 hardware = std::thread::hardware_concurrency();
+		threadCount = (hardware > 1) ? hardware - 1 : 0;
+	}
+	for(uint32 i = 0; i < threadCount; ++i) {
+		workers.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for(std::thread& t : workers) { t.join(); }
+}
+
+void ThreadPool::WorkerLoop() {
+	while(true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this]() { return stopping || !tasks.empty(); });
+			if(tasks.empty()) { return; } //only empty here when stopping
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+		task();
+	}
+}
+
+bool ThreadPool::RunPendingTask() {
+	std::function<void()> task;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if(tasks.empty()) { return false; }
+		task = std::move(tasks.front());
+		tasks.pop_front();
+	}
+	task();
+	return true;
+}
+
+void ThreadPool::ParallelFor(uint32 count, const std::function<void(uint32)>& job) {
+	if(count == 0) { return; }
+	if(workers.empty() || count == 1) {
+		for(uint32 i = 0; i < count; ++i) { job(i); }
+		return;
+	}
+
+	std::atomic<uint32> next{0};
+	std::atomic<uint32> running{0};
+	auto work = [&]() {
+		for(uint32 i = next.fetch_add(1); i < count; i = next.fetch_add(1)) { job(i); }
+	};
+
+	uint32 helpers = std::min((uint32)workers.size(), count - 1);
+	running = helpers;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for(uint32 i = 0; i < helpers; ++i) {
+			tasks.push_back([&]() { work(); running.fetch_sub(1); });
+		}
+	}
+	wake.notify_all();
+
+	work();
+
+	//helpers that havent started yet still touch this stack frame, so wait for all of them
+	//running other queued tasks meanwhile keeps nested calls from deadlocking
+	while(running.load() > 0) {
+		if(!RunPendingTask()) { std::this_thread::yield(); }
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "UsefulDefines.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <atomic>
+
+//fixed set of worker threads that frame work gets split across
+//the thread calling into the pool always does work too, so a pool on a single core machine
+//has no workers and just runs everything inline
+struct ThreadPool {
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping = false;
+
+	//threadCount of 0 uses one worker per hardware thread besides the calling one
+	ThreadPool(uint32 threadCount = 0);
+	~ThreadPool();
+
+	//runs job(i) for every i in [0, count) across the workers and the calling thread, returns once all have finished
+	//indices are handed out one at a time so uneven jobs (eg. busy screen tiles) balance themselves
+	void ParallelFor(uint32 count, const std::function<void(uint32)>& job);
+
+	//runs one queued task on the calling thread, returns false if there were none
+	bool RunPendingTask();
+
+	void WorkerLoop();
+};